@@ -0,0 +1,254 @@
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Binary event log wire format, shared by the writer (Logger in MAIN.cpp) and the reader (LOG_DECODER.cpp).
+// Host byte order. A session header opens every process's output:
+//   u16 kSessionMarker, char[6] kBinaryLogMagic, u16 version, u16 format count, u64 counter, i64 unix ns,
+//   then per format: u16 id, u16 length, format bytes.
+// Records follow: u16 id, u8 argument count, u8 zero, u64 counter, u64 arguments[count]. A record with id
+// kClockSyncId closes every batch and carries the unix time in ns at its counter reading. The writer orders each
+// batch by counter, but an event still queued in a thread's ring at a drain lands in a later batch, so readers
+// order the whole session.
+namespace binary_log {
+
+    inline constexpr uint16_t kSessionMarker = 0xFFFF;
+    inline constexpr uint16_t kClockSyncId = 0xFFFE;
+    inline constexpr uint16_t kBinaryLogVersion = 1;
+    inline constexpr size_t kMaxEventArguments = 4;
+    inline constexpr char kBinaryLogMagic[] = "TSBLOG";
+    inline constexpr size_t kBinaryLogMagicLength = sizeof(kBinaryLogMagic) - 1;
+
+    struct ClockSync {
+        uint64_t counter;
+        int64_t unixNs;
+    };
+
+    struct Event {
+        uint16_t id;
+        uint64_t counter;
+        std::vector<uint64_t> arguments;
+    };
+
+    // Everything one process wrote between its session header and the next one
+    struct Session {
+        std::map<uint16_t, std::string> formats;
+        std::vector<ClockSync> syncs;
+        std::vector<Event> events;
+    };
+
+    // Bounds-checked reader over the whole file
+    class Reader {
+    public:
+        explicit Reader(const std::string& bytes) : bytes_(bytes) {}
+
+        bool AtEnd() const {
+            return offset_ >= bytes_.size();
+        }
+
+        template<typename T>
+        bool Read(T& value) {
+            if (bytes_.size() - offset_ < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, bytes_.data() + offset_, sizeof(T));
+            offset_ += sizeof(T);
+            return true;
+        }
+
+        bool ReadString(size_t length, std::string& value) {
+            if (bytes_.size() - offset_ < length) {
+                return false;
+            }
+            value.assign(bytes_, offset_, length);
+            offset_ += length;
+            return true;
+        }
+
+    private:
+        const std::string& bytes_;
+        size_t offset_ = 0;
+    };
+
+    // Reads the rest of a session header once its marker has been consumed
+    inline bool ReadSessionHeader(Reader& reader, Session& session) {
+        std::string magic;
+        uint16_t version = 0;
+        uint16_t formatCount = 0;
+        ClockSync sync;
+        if (!reader.ReadString(kBinaryLogMagicLength, magic) || magic != kBinaryLogMagic || !reader.Read(version) ||
+            version != kBinaryLogVersion || !reader.Read(formatCount) || !reader.Read(sync.counter) ||
+            !reader.Read(sync.unixNs)) {
+            return false;
+        }
+        session.syncs.push_back(sync);
+
+        for (uint16_t i = 0; i < formatCount; ++i) {
+            uint16_t id = 0;
+            uint16_t length = 0;
+            std::string format;
+            if (!reader.Read(id) || !reader.Read(length) || !reader.ReadString(length, format)) {
+                return false;
+            }
+            session.formats[id] = format;
+        }
+        return true;
+    }
+
+    // Orders a session's events and sync points by counter; events with equal counters keep their file order
+    inline void SortSession(Session& session) {
+        std::stable_sort(session.events.begin(), session.events.end(),
+            [](const Event& a, const Event& b) { return a.counter < b.counter; });
+        std::sort(session.syncs.begin(), session.syncs.end(),
+            [](const ClockSync& a, const ClockSync& b) { return a.counter < b.counter; });
+    }
+
+    // Records of every session in file order
+    inline bool ReadRecords(const std::string& bytes, std::vector<Session>& sessions) {
+        Reader reader(bytes);
+        while (!reader.AtEnd()) {
+            uint16_t id = 0;
+            if (!reader.Read(id)) {
+                return false;
+            }
+
+            if (id == kSessionMarker) {
+                sessions.emplace_back();
+                if (!ReadSessionHeader(reader, sessions.back())) {
+                    return false;
+                }
+                continue;
+            }
+            if (sessions.empty()) {
+                return false;
+            }
+
+            uint8_t argumentCount = 0;
+            uint8_t reserved = 0;
+            Event event{ id, 0, {} };
+            if (!reader.Read(argumentCount) || !reader.Read(reserved) || !reader.Read(event.counter)) {
+                return false;
+            }
+            event.arguments.resize(argumentCount);
+            for (uint64_t& argument : event.arguments) {
+                if (!reader.Read(argument)) {
+                    return false;
+                }
+            }
+
+            if (id == kClockSyncId) {
+                if (event.arguments.size() != 1) {
+                    return false;
+                }
+                sessions.back().syncs.push_back({ event.counter, static_cast<int64_t>(event.arguments[0]) });
+            }
+            else {
+                sessions.back().events.push_back(std::move(event));
+            }
+        }
+        return true;
+    }
+
+    // Returns false on a truncated or malformed file; sessions read so far are kept. Each session comes back in
+    // counter order across all of its batches.
+    inline bool ReadLog(const std::string& bytes, std::vector<Session>& sessions) {
+        size_t first = sessions.size();
+        bool complete = ReadRecords(bytes, sessions);
+        for (size_t i = first; i < sessions.size(); ++i) {
+            SortSession(sessions[i]);
+        }
+        return complete;
+    }
+
+    // Interpolates between the two sync points around the counter, extrapolating from the edge pair outside them
+    inline int64_t ToUnixNs(const std::vector<ClockSync>& syncs, uint64_t counter) {
+        if (syncs.size() == 1) {
+            return syncs[0].unixNs;
+        }
+        auto upper = std::upper_bound(syncs.begin(), syncs.end(), counter,
+            [](uint64_t value, const ClockSync& sync) { return value < sync.counter; });
+        if (upper == syncs.begin()) {
+            ++upper;
+        }
+        if (upper == syncs.end()) {
+            --upper;
+        }
+        const ClockSync& a = *(upper - 1);
+        const ClockSync& b = *upper;
+        if (b.counter == a.counter) {
+            return a.unixNs;
+        }
+        double ticks = static_cast<double>(static_cast<int64_t>(counter - a.counter));
+        double nsPerTick = static_cast<double>(b.unixNs - a.unixNs) / static_cast<double>(b.counter - a.counter);
+        return a.unixNs + static_cast<int64_t>(ticks * nsPerTick);
+    }
+
+    // Expands printf conversions with the raw 64-bit arguments; the conversion letter picks the argument type
+    inline std::string FormatEvent(const std::string& format, const std::vector<uint64_t>& arguments) {
+        std::string out;
+        size_t next = 0;
+        char buffer[128];
+
+        for (size_t i = 0; i < format.size(); ++i) {
+            if (format[i] != '%') {
+                out += format[i];
+                continue;
+            }
+            if (i + 1 < format.size() && format[i + 1] == '%') {
+                out += '%';
+                ++i;
+                continue;
+            }
+
+            // Keep flags, width and precision; drop length modifiers since every argument is 64-bit
+            std::string spec = "%";
+            size_t j = i + 1;
+            while (j < format.size() && std::strchr("-+ #0123456789.", format[j])) {
+                spec += format[j++];
+            }
+            while (j < format.size() && std::strchr("hlLqjzt", format[j])) {
+                ++j;
+            }
+            if (j >= format.size()) {
+                out += format.substr(i);
+                break;
+            }
+            char conversion = format[j];
+            i = j;
+
+            if (next >= arguments.size()) {
+                out += "<missing>";
+                continue;
+            }
+            uint64_t raw = arguments[next++];
+
+            if (std::strchr("fFeEgGaA", conversion)) {
+                double value;
+                std::memcpy(&value, &raw, sizeof(value));
+                std::snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(), value);
+            }
+            else if (conversion == 'd' || conversion == 'i') {
+                std::snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(), static_cast<long long>(raw));
+            }
+            else if (std::strchr("uxXo", conversion)) {
+                std::snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(), static_cast<unsigned long long>(raw));
+            }
+            else {
+                std::snprintf(buffer, sizeof(buffer), "<%%%c?>", conversion);
+            }
+            out += buffer;
+        }
+        return out;
+    }
+
+} // namespace binary_log
+
+#endif
@@ -0,0 +1,62 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "BINARY_LOG.h"
+
+// Offline decoder for the binary event log written by Logger::Event in MAIN.cpp.
+// Usage: LOG_DECODER [file]   (defaults to CONFIG_BINARY_LOG_FILE), prints one text line per event.
+
+using binary_log::Event;
+using binary_log::Session;
+using binary_log::FormatEvent;
+using binary_log::ToUnixNs;
+
+// Same layout as the text log timestamps
+std::string FormatTime(int64_t unixNs) {
+    std::time_t seconds = static_cast<std::time_t>(unixNs / 1000000000);
+    long long micros = (unixNs / 1000) % 1000000;
+    std::tm local;
+    localtime_r(&seconds, &local);
+
+    char stamp[64];
+    size_t length = std::strftime(stamp, sizeof(stamp), "%a %b %d %H:%M:%S", &local);
+    std::snprintf(stamp + length, sizeof(stamp) - length, ".%06lld %d", micros, local.tm_year + 1900);
+    return stamp;
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : CONFIG_BINARY_LOG_FILE;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return 1;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<Session> sessions;
+    bool complete = binary_log::ReadLog(bytes, sessions);
+
+    // ReadLog returns every session's events in counter order, across drain batches
+    for (const Session& session : sessions) {
+        for (const Event& event : session.events) {
+            auto format = session.formats.find(event.id);
+            std::string text = format != session.formats.end()
+                ? FormatEvent(format->second, event.arguments)
+                : "unknown event " + std::to_string(event.id);
+            std::cout << "[EVENT] [" << FormatTime(ToUnixNs(session.syncs, event.counter)) << "] " << text << '\n';
+        }
+    }
+
+    if (!complete) {
+        std::cerr << "Truncated or malformed log, stopped decoding" << std::endl;
+        return 1;
+    }
+    return 0;
+}
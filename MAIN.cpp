@@ -2,6 +2,10 @@
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/websocket.hpp>
+#include <boost/asio/co_spawn.hpp> // Coroutine session
+#include <boost/asio/detached.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -9,21 +13,110 @@
 #include <chrono>
 #include <vector>
 #include <deque>
+#include <array>
+#include <unordered_map>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <optional>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <nlohmann/json.hpp>
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <iterator>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TRADE_SIM_X86_SIMD 1
+#include <immintrin.h> // Runtime-dispatched SIMD kernels
+#else
+#define TRADE_SIM_X86_SIMD 0
+#endif
+#ifdef __linux__
+#include <pthread.h> // Thread affinity and names
+#include <sched.h>
+#endif
 #include <gtest/gtest.h> // For unit tests
 
 // Configuration
 #include "config.h" // Create this file for configuration parameters
+#include "BINARY_LOG.h" // Binary event log wire format, shared with LOG_DECODER.cpp
 
 // Order Book Data Structure
 struct OrderBook {
     std::string symbol;
+    std::string venue = CONFIG_EXCHANGE; // Exchange the book was received from
     std::vector<std::pair<double, double>> asks;
     std::vector<std::pair<double, double>> bids;
     std::chrono::system_clock::time_point timestamp;
+    double askTailSize = 0.0; // Aggregate size of ask levels dropped by depth truncation
+    double bidTailSize = 0.0; // Aggregate size of bid levels dropped by depth truncation
+
+    // Dirty range: shallowest level that differs from the previous book (Unchanged if none)
+    static constexpr size_t Unchanged = std::numeric_limits<size_t>::max();
+    uint64_t sequence = 0; // Position in the ingest stream
+    size_t askDirtyFrom = 0;
+    size_t bidDirtyFrom = 0;
+};
+
+// First level index at which two versions of a book side differ
+size_t FirstChangedLevel(const std::vector<std::pair<double, double>>& previous,
+    const std::vector<std::pair<double, double>>& current) {
+    size_t common = std::min(previous.size(), current.size());
+    for (size_t i = 0; i < common; ++i) {
+        if (previous[i] != current[i]) {
+            return i;
+        }
+    }
+    return previous.size() == current.size() ? OrderBook::Unchanged : common;
+}
+
+// Order Side
+enum class Side { Buy, Sell };
+
+// Price that slippage is measured against
+enum class SlippageReference { Mid, Touch, Arrival };
+
+// Compile-time side traits: the book side a market order consumes and the direction of an adverse price
+template <Side S> struct SideTraits;
+
+template <> struct SideTraits<Side::Buy> {
+    static const std::vector<std::pair<double, double>>& Levels(const OrderBook& book) { return book.asks; }
+    static double TailSize(const OrderBook& book) { return book.askTailSize; }
+    static size_t DirtyFrom(const OrderBook& book) { return book.askDirtyFrom; }
+    // Side a passive order on S rests on
+    static const std::vector<std::pair<double, double>>& Resting(const OrderBook& book) { return book.bids; }
+    static bool TradedThrough(double touch, double price) { return touch < price; } // Resting bid was crossed
+    static constexpr double Sign = 1.0; // Paying above the reference is a cost
+};
+
+template <> struct SideTraits<Side::Sell> {
+    static const std::vector<std::pair<double, double>>& Levels(const OrderBook& book) { return book.bids; }
+    static double TailSize(const OrderBook& book) { return book.bidTailSize; }
+    static size_t DirtyFrom(const OrderBook& book) { return book.bidDirtyFrom; }
+    static const std::vector<std::pair<double, double>>& Resting(const OrderBook& book) { return book.asks; }
+    static bool TradedThrough(double touch, double price) { return touch > price; } // Resting ask was lifted through
+    static constexpr double Sign = -1.0; // Receiving below the reference is a cost
+};
+
+// Price for size past the visible levels of a side: the last level worsened by CONFIG_TAIL_PRICE_PENALTY
+template <Side S>
+double TailPrice(const std::vector<std::pair<double, double>>& levels) {
+    return levels.back().first * (1.0 + SideTraits<S>::Sign * CONFIG_TAIL_PRICE_PENALTY);
+}
+
+// Where the volatility a simulation used came from
+enum class VolatilitySource {
+    Input, // Supplied by the caller
+    Default, // CONFIG_DEFAULT_VOLATILITY while the streaming estimator warms up
+    Live // Streaming estimate from the book stream
 };
 
 // Trade Simulation Results
@@ -34,394 +127,5220 @@ struct SimulationResults {
     double netCost = 0.0;
     double makerTakerRatio = 0.0;
     double latency = 0.0;
+    double volatility = 0.0; // Volatility the models were evaluated with
+    VolatilitySource volatilitySource = VolatilitySource::Input;
+    double estimatedSlippage = 0.0; // Constant-time regression estimate for the same size
+    double unfilledQuantity = 0.0; // Size beyond the visible levels and the truncated tail (priced, but not really there)
 };
 
-// Global Variables with Mutex
-std::deque<OrderBook> orderBookHistory;
-std::mutex orderBookMutex;
-SimulationResults currentResults;
-std::mutex resultsMutex;
-bool shouldStop = false;
-std::condition_variable cv;
-std::mutex cvMutex;
+// Spin-wait hint for busy-poll loops
+inline void CpuRelax() {
+#if TRADE_SIM_X86_SIMD
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
 
-// Logging
-class Logger {
+// Lock-Free Handoff
+// Bounded single-producer single-consumer ring. The consumer and producer indices sit on separate cache lines and
+// each side caches the other's index, so a transfer touches no shared line unless the cached view is stale.
+// An idle consumer can block in Wait(), which spins briefly and then sleeps on a futex (std::atomic::wait) after
+// announcing itself; the producer only pays for a wakeup while the consumer is asleep.
+template <typename T>
+class SpscRing {
 public:
-    static void Log(const std::string& message, const std::string& level = "INFO") {
-        std::ofstream logFile(LOG_FILE, std::ios::app);
-        auto now = std::chrono::system_clock::now();
-        auto now_c = std::chrono::system_clock::to_time_t(now);
-        logFile << "[" << level << "] [" << std::ctime(&now_c) << "] " << message << std::endl;
-    }
-};
+    explicit SpscRing(size_t capacity) : slots_(RoundUpPowerOfTwo(capacity)), mask_(slots_.size() - 1) {}
 
-// Exception Handling Utility
-class ExceptionHandler {
-public:
-    static void HandleException(const std::exception& e, const std::string& context) {
-        Logger::Log(context + ": " + e.what(), "ERROR");
-        // Additional exception handling logic can be added here
-    }
-};
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
 
-// WebSocket Handler
-class WebSocketHandler {
-public:
-    WebSocketHandler(boost::asio::io_context& ioc)
-        : resolver_(ioc), ws_(ioc), lastPing_(std::chrono::steady_clock::now()) {
-    }
+    // Producer only. Moves value in and returns true, or returns false leaving value intact when full
+    bool TryPush(T&& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ == slots_.size()) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ == slots_.size()) {
+                return false;
+            }
+        }
 
-    void Connect() {
-        try {
-            // Resolve the domain name
-            auto const results = resolver_.resolve(
-                CONFIG_HOST, CONFIG_PORT);
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
 
-            // Make the connection on the IP address we get from a lookup
-            beast::get_lowest_layer(ws_).connect(results);
+        // Pairs with the fence in Wait: either the consumer sees the new element or we see it idle
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idle_.load(std::memory_order_relaxed)) {
+            signal_.fetch_add(1, std::memory_order_release);
+            signal_.notify_one();
+        }
+        return true;
+    }
 
-            // Perform the WebSocket handshake
-            ws_.handshake(CONFIG_HOST, CONFIG_PATH);
+    // Consumer only
+    bool TryPop(T& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) {
+                return false;
+            }
+        }
 
-            Logger::Log("WebSocket connection established successfully.");
+        out = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
 
-            // Start the asynchronous read loop
-            StartAsyncRead();
+    // Consumer only
+    bool Empty() const {
+        return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+    }
 
+    // Consumer only. Sleeps until an element is available or the ring is closed
+    void Wait() {
+        for (int spin = 0; spin < CONFIG_QUEUE_SPIN_ITERATIONS && Empty() && !Closed(); ++spin) {
+            CpuRelax();
         }
-        catch (const std::exception& e) {
-            ExceptionHandler::HandleException(e, "WebSocket connection error");
-            RetryConnection();
+        while (Empty() && !Closed()) {
+            uint32_t ticket = signal_.load(std::memory_order_acquire);
+            idle_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (Empty() && !Closed()) {
+                signal_.wait(ticket, std::memory_order_acquire);
+            }
+            idle_.store(false, std::memory_order_relaxed);
         }
     }
 
-    void StartAsyncRead() {
-        ws_.async_read(
-            buffer_,
-            [this](beast::error_code ec, std::size_t bytes_transferred) {
-                if (ec) {
-                    if (ec != websocket::error::closed) {
-                        ExceptionHandler::HandleException(
-                            beast::system_error(ec), "Async read error");
-                    }
-                    return;
-                }
+    // Wakes a waiting consumer for shutdown
+    void Close() {
+        closed_.store(true, std::memory_order_release);
+        signal_.fetch_add(1, std::memory_order_release);
+        signal_.notify_all();
+    }
 
-                // Process the received data
-                ProcessData(buffer_.data());
+    bool Closed() const { return closed_.load(std::memory_order_acquire); }
+    size_t Capacity() const { return slots_.size(); }
 
-                // Continue reading
-                StartAsyncRead();
-            });
+private:
+    static size_t RoundUpPowerOfTwo(size_t value) {
+        size_t capacity = 1;
+        while (capacity < value) {
+            capacity <<= 1;
+        }
+        return capacity;
     }
 
-    void ProcessData(beast::multi_buffer const& buffer) {
-        try {
-            // Convert the buffer to a string
-            auto data = buffer.data();
-            std::string json_str(data.begin(), data.end());
+    // Read-only after construction
+    std::vector<T> slots_;
+    size_t mask_;
 
-            // Validate and parse JSON data
-            if (!ValidateJson(json_str)) {
-                Logger::Log("Invalid JSON data received.", "WARNING");
-                return;
-            }
+    alignas(64) std::atomic<size_t> head_{ 0 }; // Consumer
+    size_t tailCache_ = 0;
+    alignas(64) std::atomic<size_t> tail_{ 0 }; // Producer
+    size_t headCache_ = 0;
+    alignas(64) std::atomic<bool> idle_{ false }; // Consumer is (about to be) asleep
+    std::atomic<uint32_t> signal_{ 0 };
+    std::atomic<bool> closed_{ false };
+};
 
-            auto json = nlohmann::json::parse(json_str);
+// Broadcast Ring
+// Disruptor-style single-producer ring read by several consumers, each at its own pace through its own cursor.
+// Consumers read elements in place, so a book is never copied per consumer; a slot is reused only after every
+// consumer has moved past it. When the slowest consumer is a full ring behind, the full policy decides whether the
+// producer drops the new element (counted in Dropped) or waits. Register consumers before publishing.
+enum class RingFullPolicy {
+    Drop,
+    Block
+};
 
-            // Create OrderBook object
-            OrderBook book;
-            book.symbol = json["symbol"];
-            book.timestamp = std::chrono::system_clock::now();
+template <typename T>
+class BroadcastRing {
+public:
+    static constexpr size_t MaxConsumers = 16;
 
-            // Parse asks
-            for (const auto& ask : json["asks"]) {
-                book.asks.emplace_back(ask[0].get<double>(), ask[1].get<double>());
-            }
+    explicit BroadcastRing(size_t capacity, RingFullPolicy policy = RingFullPolicy::Drop)
+        : slots_(RoundUpPowerOfTwo(capacity)), mask_(slots_.size() - 1), policy_(policy) {}
 
-            // Parse bids
-            for (const auto& bid : json["bids"]) {
-                book.bids.emplace_back(bid[0].get<double>(), bid[1].get<double>());
-            }
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
 
-            // Add to history with mutex protection
-            {
-                std::lock_guard<std::mutex> lock(orderBookMutex);
-                if (orderBookHistory.size() >= CONFIG_MAX_HISTORY) {
-                    orderBookHistory.pop_front();
+    // Producer only, before the first Publish: reallocates the slots from the calling thread, so first touch
+    // places them on that thread's NUMA node
+    void PlaceSlots() {
+        std::vector<T>(slots_.size()).swap(slots_);
+    }
+
+    // Returns the consumer's id; it starts at the next element to be published
+    size_t AddConsumer() {
+        size_t consumer = consumerCount_.load(std::memory_order_relaxed);
+        if (consumer == MaxConsumers) {
+            throw std::invalid_argument("Too many broadcast consumers");
+        }
+        cursors_[consumer].next.store(published_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        consumerCount_.store(consumer + 1, std::memory_order_release);
+        return consumer;
+    }
+
+    // Producer only. Publishes unless the slot is still being read: a Drop ring then discards value and returns
+    // false, a Block ring waits for the slowest consumer. False once the ring is closed.
+    bool Publish(T&& value) {
+        uint64_t sequence = published_.load(std::memory_order_relaxed);
+        while (sequence - gatingCache_ >= slots_.size()) {
+            gatingCache_ = MinimumCursor(sequence);
+            if (sequence - gatingCache_ >= slots_.size()) {
+                if (policy_ == RingFullPolicy::Drop) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (Closed()) {
+                    return false;
                 }
-                orderBookHistory.push_back(book);
+                std::this_thread::yield();
             }
+        }
 
-            // Notify waiting threads
-            {
-                std::lock_guard<std::mutex> lock(cvMutex);
-                cv.notify_all();
-            }
+        slots_[sequence & mask_] = std::move(value);
+        published_.store(sequence + 1, std::memory_order_release);
 
+        // Pairs with the fence in Wait: either a consumer sees the element or we see it waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            signal_.fetch_add(1, std::memory_order_release);
+            signal_.notify_all();
         }
-        catch (const std::exception& e) {
-            ExceptionHandler::HandleException(e, "Data processing error");
-        }
+        return true;
     }
 
-    void RetryConnection() {
-        std::this_thread::sleep_for(std::chrono::seconds(CONFIG_RETRY_INTERVAL));
-        try {
-            resolver_.clear();
-            ws_.next_layer().close();
-            Connect();
-        }
-        catch (const std::exception& e) {
-            ExceptionHandler::HandleException(e, "Connection retry failed");
-            RetryConnection();
-        }
+    // Producer only. Most recently published element, or nullptr
+    const T* Latest() const {
+        uint64_t published = published_.load(std::memory_order_relaxed);
+        return published == 0 ? nullptr : &slots_[(published - 1) & mask_];
     }
 
-    void Write(const beast::multi_buffer& buffer) {
-        try {
-            ws_.write(buffer.data());
-        }
-        catch (const beast::system_error& e) {
-            ExceptionHandler::HandleException(
-                beast::system_error(e), "WebSocket write error");
+    // Elements published so far; the next element gets this sequence
+    uint64_t Published() const { return published_.load(std::memory_order_acquire); }
+
+    // Elements a Drop ring discarded because the slowest consumer was a full ring behind
+    uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    RingFullPolicy Policy() const { return policy_; }
+
+    // Calls handler(element) for every element the consumer has not seen, then releases their slots.
+    // Returns the number of elements handled.
+    template <typename Handler>
+    size_t Consume(size_t consumer, Handler&& handler) {
+        std::atomic<uint64_t>& cursor = cursors_[consumer].next;
+        uint64_t next = cursor.load(std::memory_order_relaxed);
+        uint64_t available = published_.load(std::memory_order_acquire);
+        for (uint64_t sequence = next; sequence < available; ++sequence) {
+            handler(static_cast<const T&>(slots_[sequence & mask_]));
         }
+        cursor.store(available, std::memory_order_release);
+        return static_cast<size_t>(available - next);
     }
 
-    void Close() {
-        try {
-            ws_.close(websocket::close_code::normal);
-        }
-        catch (const std::exception& e) {
-            ExceptionHandler::HandleException(e, "Close error");
-        }
+    bool Empty(size_t consumer) const {
+        return cursors_[consumer].next.load(std::memory_order_relaxed) == published_.load(std::memory_order_acquire);
     }
 
-    void Ping() {
-        auto now = std::chrono::steady_clock::now();
-        if (now - lastPing_ > std::chrono::seconds(CONFIG_PING_INTERVAL)) {
-            try {
-                ws_.ping("heartbeat");
-                lastPing_ = now;
-            }
-            catch (const std::exception& e) {
-                ExceptionHandler::HandleException(e, "Ping error");
+    // Sleeps until the consumer has an element to read or the ring is closed, spinning briefly first
+    void Wait(size_t consumer) {
+        for (int spin = 0; spin < CONFIG_QUEUE_SPIN_ITERATIONS && Empty(consumer) && !Closed(); ++spin) {
+            CpuRelax();
+        }
+        while (Empty(consumer) && !Closed()) {
+            uint32_t ticket = signal_.load(std::memory_order_acquire);
+            waiters_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (Empty(consumer) && !Closed()) {
+                signal_.wait(ticket, std::memory_order_acquire);
             }
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
         }
     }
 
+    // Wakes every waiting consumer and producer for shutdown
+    void Close() {
+        closed_.store(true, std::memory_order_release);
+        signal_.fetch_add(1, std::memory_order_release);
+        signal_.notify_all();
+    }
+
+    bool Closed() const { return closed_.load(std::memory_order_acquire); }
+
 private:
-    bool ValidateJson(const std::string& json_str) {
-        try {
-            auto json = nlohmann::json::parse(json_str);
-            if (!json.contains("symbol") || !json.contains("asks") || !json.contains("bids")) {
-                return false;
-            }
-            return true;
+    struct alignas(64) Cursor {
+        std::atomic<uint64_t> next{ 0 }; // First sequence the consumer has not read
+    };
+
+    static size_t RoundUpPowerOfTwo(size_t value) {
+        size_t capacity = 1;
+        while (capacity < value) {
+            capacity <<= 1;
         }
-        catch (...) {
-            return false;
+        return capacity;
+    }
+
+    uint64_t MinimumCursor(uint64_t sequence) const {
+        uint64_t minimum = sequence;
+        size_t consumers = consumerCount_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < consumers; ++i) {
+            minimum = std::min(minimum, cursors_[i].next.load(std::memory_order_acquire));
         }
+        return minimum;
     }
 
-    tcp::resolver resolver_;
-    websocket::stream<beast::tcp_stream> ws_;
-    beast::flat_buffer buffer_;
-    std::chrono::steady_clock::time_point lastPing_;
+    // Read-only after construction
+    std::vector<T> slots_;
+    size_t mask_;
+    RingFullPolicy policy_;
+
+    alignas(64) std::atomic<uint64_t> published_{ 0 }; // Producer
+    uint64_t gatingCache_ = 0;
+    std::atomic<uint64_t> dropped_{ 0 };
+    alignas(64) std::atomic<uint32_t> waiters_{ 0 }; // Consumers asleep or about to sleep
+    std::atomic<uint32_t> signal_{ 0 };
+    std::atomic<bool> closed_{ false };
+    std::atomic<size_t> consumerCount_{ 0 };
+    std::array<Cursor, MaxConsumers> cursors_;
 };
 
-// Trade Simulator
-class TradeSimulator {
-public:
-    SimulationResults SimulateTrade(double quantity, double volatility, double feeTier) {
-        try {
-            ValidateInputs(quantity, volatility, feeTier);
+// Process-wide shutdown request, set from the SIGINT handler; all other state lives in a TradingEngine
+std::atomic<bool> shouldStop{ false };
 
-            SimulationResults results;
-            OrderBook currentBook;
+// Number a book after the latest one in the ingest stream (any venue) and record which levels changed since the
+// previous book of its own venue; a venue's first book is dirty from level 0
+void StampBook(OrderBook& book, const OrderBook* latest, const OrderBook* previous) {
+    book.sequence = latest ? latest->sequence + 1 : 1;
+    if (previous) {
+        book.askDirtyFrom = FirstChangedLevel(previous->asks, book.asks);
+        book.bidDirtyFrom = FirstChangedLevel(previous->bids, book.bids);
 
-            {
-                std::lock_guard<std::mutex> lock(orderBookMutex);
-                if (!orderBookHistory.empty()) {
-                    currentBook = orderBookHistory.back();
-                }
-            }
+        // A changed tail only affects fills that ran past the visible levels
+        if (book.askDirtyFrom == OrderBook::Unchanged && book.askTailSize != previous->askTailSize) {
+            book.askDirtyFrom = book.asks.size();
+        }
+        if (book.bidDirtyFrom == OrderBook::Unchanged && book.bidTailSize != previous->bidTailSize) {
+            book.bidDirtyFrom = book.bids.size();
+        }
+    }
+}
 
-            if (currentBook.bids.empty() || currentBook.asks.empty()) {
-                return results;
-            }
+// Book Store
+// Bounded history of published books, oldest first; lock mutex to read history
+struct BookStore {
+    std::deque<OrderBook> history;
+    std::mutex mutex;
 
-            // Measure latency
-            auto start = std::chrono::high_resolution_clock::now();
+    void Append(const OrderBook& book) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (history.size() >= CONFIG_MAX_HISTORY) {
+            history.pop_front();
+        }
+        history.push_back(book);
+    }
+};
+
+// Depth Truncation
+// Keeps the first maxDepth levels of a book side and summarises the rest as tailSize (0 keeps every level)
+void ParseBookSide(const nlohmann::json& levels, size_t maxDepth,
+    std::vector<std::pair<double, double>>& out, double& tailSize) {
+    size_t keep = levels.size();
+    if (maxDepth > 0 && maxDepth < keep) {
+        keep = maxDepth;
+    }
 
-            // Calculate slippage
-            results.slippage = CalculateSlippage(quantity, currentBook);
+    out.reserve(keep);
+    tailSize = 0.0;
 
-            // Calculate fees
-            results.fees = quantity * feeTier;
+    size_t index = 0;
+    for (const auto& level : levels) {
+        if (index++ < keep) {
+            out.emplace_back(level[0].get<double>(), level[1].get<double>());
+        }
+        else {
+            tailSize += level[1].get<double>();
+        }
+    }
+}
 
-            // Calculate market impact (Almgren-Chriss model)
-            results.marketImpact = CalculateMarketImpact(quantity, volatility);
+// Binary Event Log
+// Per-message events are recorded as a format ID, up to four raw 64-bit arguments and a timestamp-counter reading.
+// The format strings are written once per session in the file header and rendered offline by LOG_DECODER.cpp.
+enum class LogEvent : uint16_t {
+    BookReceived,
+    BookParsed,
+    BookPublished,
+    Count
+};
 
-            // Calculate maker/taker ratio
-            results.makerTakerRatio = PredictMakerTakerRatio(quantity, volatility);
+struct LogEventFormat {
+    LogEvent id;
+    const char* format; // %f/%e/%g read a double, %d/%i a signed and %u/%x an unsigned 64-bit argument
+};
 
-            // Calculate net cost
-            results.netCost = results.slippage + results.fees + results.marketImpact;
+inline constexpr LogEventFormat kLogEventFormats[] = {
+    { LogEvent::BookReceived, "book received: %u bytes" },
+    { LogEvent::BookParsed, "book parsed: %u ask levels, %u bid levels in %u ns" },
+    { LogEvent::BookPublished, "book published: sequence %u" },
+};
+static_assert(std::size(kLogEventFormats) == static_cast<size_t>(LogEvent::Count), "Every LogEvent needs a format");
 
-            // Measure latency
-            auto end = std::chrono::high_resolution_clock::now();
-            results.latency = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+// Raw clock for event stamps; the decoder maps it to wall time through the clock sync records
+inline uint64_t ReadTimestampCounter() {
+#if TRADE_SIM_X86_SIMD
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
 
-            return results;
+// Logging
+// Log() copies the record into the calling thread's lock-free SPSC ring and returns; a background thread drains
+// every ring, orders the batch by time and writes it with one fwrite to a file kept open. A full ring drops the
+// record rather than stalling the caller, and the drop count is reported in the log.
+class Logger {
+public:
+    static void Log(const std::string& message, const std::string& level = "INFO") {
+        Instance().Enqueue(message, level);
+    }
 
+    // Hot-path binary event: no formatting and no allocation, only a ring push
+    template<typename... Args>
+    static void Event(LogEvent id, Args... args) {
+        static_assert(sizeof...(Args) <= binary_log::kMaxEventArguments, "Too many event arguments");
+        if constexpr (CONFIG_BINARY_LOG) {
+            Logger& logger = Instance();
+            EventRecord record{ ReadTimestampCounter(), static_cast<uint16_t>(id), sizeof...(Args), { RawArgument(args)... } };
+            ThreadRing& ring = logger.LocalRing();
+            if (!ring.events.TryPush(std::move(record))) {
+                ring.droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            }
         }
-        catch (const std::exception& e) {
-            ExceptionHandler::HandleException(e, "Trade simulation error");
-            return SimulationResults();
+    }
+
+    // Blocks until every record logged before the call is written
+    static void Flush() {
+        Instance().Drain();
+    }
+
+    ~Logger() {
+        stopping_.store(true, std::memory_order_release);
+        flusher_.join();
+        Drain();
+        if (file_) {
+            std::fclose(file_);
+        }
+        if (eventFile_) {
+            std::fclose(eventFile_);
         }
     }
 
 private:
-    void ValidateInputs(double quantity, double volatility, double feeTier) {
-        if (quantity <= 0) throw std::invalid_argument("Quantity must be positive");
-        if (volatility < 0) throw std::invalid_argument("Volatility cannot be negative");
-        if (feeTier < 0 || feeTier > 1) throw std::invalid_argument("Fee tier must be between 0 and 1");
-    }
+    struct LogRecord {
+        std::chrono::system_clock::time_point time;
+        char level[8];
+        uint32_t length;
+        char text[CONFIG_LOG_RECORD_BYTES];
+    };
 
-    double CalculateSlippage(double orderQty, const OrderBook& book) {
-        double filled = 0;
-        double cost = 0;
-        double initialPrice = book.bids[0].first;
+    struct EventRecord {
+        uint64_t counter;
+        uint16_t id;
+        uint8_t argumentCount;
+        uint64_t arguments[binary_log::kMaxEventArguments];
+    };
 
-        for (const auto& ask : book.asks) {
-            double price = ask.first;
-            double size = ask.second;
-            double take = std::min(orderQty - filled, size);
+    // One per logging thread; kept until drained after the thread exits
+    struct ThreadRing {
+        SpscRing<LogRecord> records{ CONFIG_LOG_RING_RECORDS };
+        SpscRing<EventRecord> events{ CONFIG_BINARY_LOG_RING_RECORDS };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<uint64_t> droppedEvents{ 0 };
+        std::atomic<bool> retired{ false };
+    };
 
-            cost += take * price;
-            filled += take;
+    // Marks the thread's ring retired when the thread exits
+    struct RingHandle {
+        std::shared_ptr<ThreadRing> ring;
+        ~RingHandle() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
 
-            if (filled >= orderQty) break;
+    Logger() : file_(std::fopen(LOG_FILE, "a")), eventFile_(CONFIG_BINARY_LOG ? std::fopen(CONFIG_BINARY_LOG_FILE, "ab") : nullptr) {
+        if (eventFile_) {
+            WriteSessionHeader();
         }
+        flusher_ = std::thread(&Logger::FlushLoop, this);
+    }
 
-        return (cost / orderQty) - initialPrice;
+    static Logger& Instance() {
+        static Logger logger;
+        return logger;
     }
 
-    double CalculateMarketImpact(double orderQty, double volatility) {
-        // Simplified Almgren-Chriss model
-        double eta = 0.01; // Temporary market impact coefficient
-        double gamma = 0.0001; // Permanent market impact coefficient
-        double timeHorizon = 1.0; // Execution time in seconds
+    template<typename T>
+    static uint64_t RawArgument(T value) {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "Event arguments must be numbers");
+        if constexpr (std::is_floating_point_v<T>) {
+            double widened = value;
+            uint64_t bits;
+            std::memcpy(&bits, &widened, sizeof(bits));
+            return bits;
+        }
+        else if constexpr (std::is_signed_v<T>) {
+            return static_cast<uint64_t>(static_cast<int64_t>(value));
+        }
+        else {
+            return static_cast<uint64_t>(value);
+        }
+    }
 
-        return eta * orderQty + gamma * orderQty * orderQty + volatility * sqrt(orderQty) / sqrt(timeHorizon);
+    ThreadRing& LocalRing() {
+        thread_local RingHandle handle;
+        if (!handle.ring) {
+            handle.ring = std::make_shared<ThreadRing>();
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            rings_.push_back(handle.ring);
+        }
+        return *handle.ring;
     }
 
-    double PredictMakerTakerRatio(double orderQty, double volatility) {
-        // Simplified logistic regression model
-        return 1 / (1 + exp(-(0.005 * orderQty - 0.1 * volatility + 2)));
+    void Enqueue(const std::string& message, const std::string& level) {
+        ThreadRing& ring = LocalRing();
+
+        LogRecord record;
+        record.time = std::chrono::system_clock::now();
+        size_t levelLength = std::min(level.size(), sizeof(record.level) - 1);
+        std::memcpy(record.level, level.data(), levelLength);
+        record.level[levelLength] = '\0';
+        record.length = static_cast<uint32_t>(std::min(message.size(), sizeof(record.text)));
+        std::memcpy(record.text, message.data(), record.length);
+
+        if (!ring.records.TryPush(std::move(record))) {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
     }
-};
 
-// UI Component
-class TradeSimulatorUI {
-public:
-    void Render() {
-        try {
-            system("clear");
+    void FlushLoop() {
+#ifdef __linux__
+        pthread_setname_np(pthread_self(), "ts-log");
+#endif
+        while (!stopping_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(CONFIG_LOG_FLUSH_INTERVAL_MS));
+            Drain();
+        }
+    }
 
-            std::cout << "GoQuant Trade Simulator" << std::endl;
-            std::cout << "----------------------" << std::endl;
-            std::cout << "Exchange: " << CONFIG_EXCHANGE << std::endl;
-            std::cout << "Asset: " << CONFIG_ASSET << std::endl;
+    // Single consumer of every ring at a time
+    void Drain() {
+        std::lock_guard<std::mutex> drainLock(drainMutex_);
 
-            std::cout << "\nInput Parameters:" << std::endl;
-            std::cout << "Order Type: Market" << std::endl;
-            std::cout << "Quantity: " << CONFIG_DEFAULT_QUANTITY << " USD" << std::endl;
-            std::cout << "Volatility: " << CONFIG_DEFAULT_VOLATILITY << std::endl;
-            std::cout << "Fee Tier: " << CONFIG_DEFAULT_FEE_TIER * 100 << "%" << std::endl;
+        std::vector<std::shared_ptr<ThreadRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            rings = rings_;
+        }
 
-            SimulationResults results;
-            {
-                std::lock_guard<std::mutex> lock(resultsMutex);
-                results = currentResults;
+        batch_.clear();
+        eventBatch_.clear();
+        uint64_t dropped = 0;
+        uint64_t droppedEvents = 0;
+        LogRecord record;
+        EventRecord event;
+        for (const auto& ring : rings) {
+            while (ring->records.TryPop(record)) {
+                batch_.push_back(record);
             }
+            while (ring->events.TryPop(event)) {
+                eventBatch_.push_back(event);
+            }
+            dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+            droppedEvents += ring->droppedEvents.exchange(0, std::memory_order_relaxed);
+        }
 
-            std::cout << "\nOutput Parameters:" << std::endl;
-            std::cout << "Expected Slippage: " << results.slippage << std::endl;
-            std::cout << "Expected Fees: " << results.fees << std::endl;
-            std::cout << "Market Impact: " << results.marketImpact << std::endl;
-            std::cout << "Net Cost: " << results.netCost << std::endl;
-            std::cout << "Maker/Taker Ratio: " << results.makerTakerRatio << std::endl;
-            std::cout << "Latency: " << results.latency << " ms" << std::endl;
+        // Forget rings whose thread exited once they are empty
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<ThreadRing>& ring) {
+                return ring->retired.load(std::memory_order_acquire) && ring->records.Empty() && ring->events.Empty();
+            }), rings_.end());
+        }
 
-            if (results.latency > CONFIG_MAX_LATENCY) {
-                std::cout << "\nWarning: High latency detected!" << std::endl;
-            }
+        WriteEvents();
 
-            std::cout << "\nPress Ctrl+C to exit..." << std::endl;
+        if (!file_ || (batch_.empty() && dropped == 0 && droppedEvents == 0)) {
+            return;
+        }
+
+        std::stable_sort(batch_.begin(), batch_.end(),
+            [](const LogRecord& a, const LogRecord& b) { return a.time < b.time; });
 
+        text_.clear();
+        for (const LogRecord& entry : batch_) {
+            AppendLine(entry.time, entry.level, entry.text, entry.length);
         }
-        catch (const std::exception& e) {
-            ExceptionHandler::HandleException(e, "UI rendering error");
+        if (dropped > 0) {
+            std::string message = std::to_string(dropped) + " log records dropped (ring full)";
+            AppendLine(std::chrono::system_clock::now(), "WARNING", message.data(), message.size());
         }
+        if (droppedEvents > 0) {
+            std::string message = std::to_string(droppedEvents) + " binary log events dropped (ring full)";
+            AppendLine(std::chrono::system_clock::now(), "WARNING", message.data(), message.size());
+        }
+
+        std::fwrite(text_.data(), 1, text_.size(), file_);
+        std::fflush(file_);
     }
-};
 
-// Simulation Worker Thread
-void SimulationWorker() {
-    TradeSimulator simulator;
-    SimulationResults results;
+    void AppendLine(std::chrono::system_clock::time_point time, const char* level, const char* text, size_t length) {
+        std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count() % 1000000;
+        std::tm local;
+        localtime_r(&seconds, &local);
 
-    while (!shouldStop) {
-        std::unique_lock<std::mutex> lock(cvMutex);
-        cv.wait(lock, [] { return !orderBookHistory.empty() || shouldStop; });
+        char stamp[64];
+        size_t stampLength = std::strftime(stamp, sizeof(stamp), "%a %b %d %H:%M:%S", &local);
+        std::snprintf(stamp + stampLength, sizeof(stamp) - stampLength, ".%06lld %d",
+            static_cast<long long>(micros), local.tm_year + 1900);
 
-        if (shouldStop) return;
+        text_ += '[';
+        text_ += level;
+        text_ += "] [";
+        text_ += stamp;
+        text_ += "] ";
+        text_.append(text, length);
+        text_ += '\n';
+    }
 
-        try {
-            // Simulate trade
-            results = simulator.SimulateTrade(
-                CONFIG_DEFAULT_QUANTITY,
-                CONFIG_DEFAULT_VOLATILITY,
-                CONFIG_DEFAULT_FEE_TIER
-            );
-
-            // Update results
-            {
-                std::lock_guard<std::mutex> lock(resultsMutex);
-                currentResults = results;
-            }
+    void WriteSessionHeader() {
+        bytes_.clear();
+        AppendBytes(binary_log::kSessionMarker);
+        bytes_.append(binary_log::kBinaryLogMagic, binary_log::kBinaryLogMagicLength);
+        AppendBytes(binary_log::kBinaryLogVersion);
+        AppendBytes(static_cast<uint16_t>(std::size(kLogEventFormats)));
+        AppendClock();
+        for (const LogEventFormat& format : kLogEventFormats) {
+            uint16_t length = static_cast<uint16_t>(std::strlen(format.format));
+            AppendBytes(static_cast<uint16_t>(format.id));
+            AppendBytes(length);
+            bytes_.append(format.format, length);
+        }
+        std::fwrite(bytes_.data(), 1, bytes_.size(), eventFile_);
+        std::fflush(eventFile_);
+    }
 
+    // Writes the drained events in counter order followed by a clock sync record (layout in BINARY_LOG.h)
+    void WriteEvents() {
+        if (!eventFile_ || eventBatch_.empty()) {
+            return;
         }
-        catch (const std::exception& e) {
-            ExceptionHandler::HandleException(e, "Simulation worker error");
+
+        std::sort(eventBatch_.begin(), eventBatch_.end(),
+            [](const EventRecord& a, const EventRecord& b) { return a.counter < b.counter; });
+
+        bytes_.clear();
+        for (const EventRecord& event : eventBatch_) {
+            AppendBytes(event.id);
+            AppendBytes(event.argumentCount);
+            AppendBytes(uint8_t{ 0 });
+            AppendBytes(event.counter);
+            bytes_.append(reinterpret_cast<const char*>(event.arguments), event.argumentCount * sizeof(uint64_t));
         }
+        AppendBytes(binary_log::kClockSyncId);
+        AppendBytes(uint8_t{ 1 });
+        AppendBytes(uint8_t{ 0 });
+        AppendClock();
+
+        std::fwrite(bytes_.data(), 1, bytes_.size(), eventFile_);
+        std::fflush(eventFile_);
     }
-}
 
-// Unit Tests
-TEST(TradeSimulatorTest, SlippageCalculation) {
-    TradeSimulator simulator;
-    OrderBook book;
-    book.bids.push_back({ 100.0, 10.0 });
-    book.asks.push_back({ 101.0, 5.0 });
-    book.asks.push_back({ 102.0, 10.0 });
+    // Counter reading and the unix time in ns taken next to it
+    void AppendClock() {
+        uint64_t counter = ReadTimestampCounter();
+        int64_t unixNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        AppendBytes(counter);
+        AppendBytes(unixNs);
+    }
 
-    std::lock_guard<std::mutex> lock(orderBookMutex);
-    orderBookHistory.push_back(book);
+    template<typename T>
+    void AppendBytes(T value) {
+        bytes_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
 
-    SimulationResults results = simulator.SimulateTrade(7.0, 0.01, 0.001);
-    EXPECT_NEAR(results.slippage, 1.0, 0.001);
-}
+    std::FILE* file_;
+    std::FILE* eventFile_;
+    std::mutex ringsMutex_;
+    std::vector<std::shared_ptr<ThreadRing>> rings_;
+    std::mutex drainMutex_;
+    std::vector<LogRecord> batch_; // Guarded by drainMutex_
+    std::string text_; // Guarded by drainMutex_
+    std::vector<EventRecord> eventBatch_; // Guarded by drainMutex_
+    std::string bytes_; // Guarded by drainMutex_
+    std::atomic<bool> stopping_{ false };
+    std::thread flusher_;
+};
 
-TEST(TradeSimulatorTest, MarketImpactCalculation) {
-    TradeSimulator simulator;
-    double impact = simulator.CalculateMarketImpact(100.0, 0.02);
+// Exception Handling Utility
+class ExceptionHandler {
+public:
+    static void HandleException(const std::exception& e, const std::string& context) {
+        Logger::Log(context + ": " + e.what(), "ERROR");
+        // Additional exception handling logic can be added here
+    }
+};
+
+// Thread Placement
+// Names the calling thread for perf/top (at most 15 characters on Linux) and pins it to cpu (negative leaves it
+// unpinned). Stages call this before allocating their buffers so first touch places them on the core's NUMA node.
+inline void ConfigureCurrentThread(const char* name, int cpu) {
+#ifdef __linux__
+    pthread_setname_np(pthread_self(), name);
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+            Logger::Log("Could not pin thread " + std::string(name) + " to CPU " + std::to_string(cpu), "WARNING");
+        }
+    }
+#else
+    (void)name;
+    (void)cpu;
+#endif
+}
+
+// Latency Instrumentation
+// Lock-free HDR-style histogram of nanosecond latencies: values below 128 ns are exact, larger values fall into
+// 64 sub-buckets per power of two (under 1.6% relative error). Any thread may record while another reads.
+class LatencyHistogram {
+public:
+    void Record(uint64_t nanoseconds) {
+        buckets_[BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (nanoseconds > max && !max_.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the given percentile (0-100)
+    uint64_t Percentile(double percentile) const {
+        uint64_t total = Count();
+        if (total == 0) {
+            return 0;
+        }
+
+        uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(total * percentile / 100.0)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                return std::min(BucketUpperBound(i), Max());
+            }
+        }
+        return Max();
+    }
+
+private:
+    static constexpr size_t LinearBuckets = 128;
+    static constexpr size_t SubBuckets = 64;
+    static constexpr size_t BucketCount = LinearBuckets + 57 * SubBuckets;
+
+    static size_t BucketIndex(uint64_t value) {
+        if (value < LinearBuckets) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - 6; // value >> shift lands in [64, 128)
+        return LinearBuckets + (shift - 1) * SubBuckets + static_cast<size_t>((value >> shift) - SubBuckets);
+    }
+
+    static uint64_t BucketUpperBound(size_t index) {
+        if (index < LinearBuckets) {
+            return index;
+        }
+        size_t shift = (index - LinearBuckets) / SubBuckets + 1;
+        uint64_t sub = (index - LinearBuckets) % SubBuckets + SubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, BucketCount> buckets_{};
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> max_{ 0 };
+};
+
+// Pipeline stages with their own histograms. Dispatch runs from completion of the websocket read to the handler
+// holding its own copy of the frame; time on the wire and in the kernel is not observable from here.
+enum class LatencyStage { Dispatch, Parse, Publish, Simulate, Render, Count };
+
+class LatencyMonitor {
+public:
+    static uint64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    LatencyHistogram& Histogram(LatencyStage stage) { return histograms_[static_cast<size_t>(stage)]; }
+    const LatencyHistogram& Histogram(LatencyStage stage) const { return histograms_[static_cast<size_t>(stage)]; }
+
+    static const char* StageName(LatencyStage stage) {
+        static const char* names[] = { "Dispatch", "Parse", "Publish", "Simulate", "Render" };
+        return names[static_cast<size_t>(stage)];
+    }
+
+private:
+    std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::Count)> histograms_;
+};
+
+// Records the lifetime of the scope into a histogram
+class StageTimer {
+public:
+    explicit StageTimer(LatencyHistogram& histogram) : histogram_(histogram), start_(LatencyMonitor::NowNs()) {}
+    ~StageTimer() { histogram_.Record(LatencyMonitor::NowNs() - start_); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    uint64_t start_;
+};
+
+// Feed the WebSocketHandler subscribes to
+struct FeedEndpoint {
+    std::string host = CONFIG_HOST;
+    std::string port = CONFIG_PORT;
+    std::string path = CONFIG_PATH;
+};
+
+// Cores for an engine's threads (negative leaves a thread unpinned)
+struct ThreadPlacement {
+    int ioCpu = CONFIG_IO_THREAD_CPU;
+    int simulationCpu = CONFIG_SIMULATION_THREAD_CPU;
+};
+
+// WebSocket Handler
+// One session coroutine on a strand connects, subscribes, reads and reconnects with exponential backoff; the
+// heartbeat is a second coroutine on the same strand. Nothing blocks the io thread. Every parsed book is published
+// into books; the session ends once stopping is set and Stop() is called.
+class WebSocketHandler {
+public:
+    WebSocketHandler(boost::asio::io_context& ioc, const FeedEndpoint& endpoint, BroadcastRing<OrderBook>& books,
+        LatencyMonitor& latency, const std::atomic<bool>& stopping)
+        : strand_(boost::asio::make_strand(ioc)), resolver_(strand_), retryTimer_(strand_), pingTimer_(strand_),
+        streamIdle_(strand_), endpoint_(endpoint), books_(books), latency_(latency), stopping_(stopping) {
+    }
+
+    // Spawns the session; it runs on the io_context's thread
+    void Start() {
+        boost::asio::co_spawn(strand_, Run(), boost::asio::detached);
+    }
+
+    // Thread-safe. Cancels pending waits and closes the connection so the session returns
+    void Stop() {
+        boost::asio::post(strand_, [this]() {
+            resolver_.cancel();
+            retryTimer_.cancel();
+            pingTimer_.cancel();
+            if (ws_ && ws_->is_open()) {
+                boost::asio::co_spawn(strand_, Close(), boost::asio::detached);
+            }
+            else if (ws_) {
+                beast::error_code ec;
+                beast::get_lowest_layer(*ws_).socket().close(ec);
+            }
+            });
+    }
+
+    // Thread-safe. Message sent after every (re)connect, and immediately if connected
+    void AddSubscription(std::string message) {
+        boost::asio::post(strand_, [this, message = std::move(message)]() mutable {
+            subscriptions_.push_back(message);
+            if (connected_) {
+                outbox_.push_back(std::move(message));
+                StartWriting();
+            }
+            });
+    }
+
+    // readCompletedNs: LatencyMonitor::NowNs() when the read that filled buffer completed
+    void ProcessData(beast::flat_buffer const& buffer, uint64_t readCompletedNs = LatencyMonitor::NowNs()) {
+        try {
+            // Convert the buffer to a string
+            std::string json_str = beast::buffers_to_string(buffer.data());
+            Logger::Event(LogEvent::BookReceived, json_str.size());
+            uint64_t parseStart = LatencyMonitor::NowNs();
+            latency_.Histogram(LatencyStage::Dispatch).Record(parseStart - readCompletedNs);
+
+            // Validate and parse JSON data
+            if (!ValidateJson(json_str)) {
+                Logger::Log("Invalid JSON data received.", "WARNING");
+                return;
+            }
+
+            auto json = nlohmann::json::parse(json_str);
+
+            // Create OrderBook object
+            OrderBook book;
+            book.symbol = json["symbol"];
+            book.venue = json.value("venue", std::string(CONFIG_EXCHANGE));
+            book.timestamp = std::chrono::system_clock::now();
+
+            // Parse asks and bids, keeping only the configured depth for this instrument
+            size_t maxDepth = GetMaxDepth(book.symbol);
+            ParseBookSide(json["asks"], maxDepth, book.asks, book.askTailSize);
+            ParseBookSide(json["bids"], maxDepth, book.bids, book.bidTailSize);
+            uint64_t parseNs = LatencyMonitor::NowNs() - parseStart;
+            latency_.Histogram(LatencyStage::Parse).Record(parseNs);
+            Logger::Event(LogEvent::BookParsed, book.asks.size(), book.bids.size(), parseNs);
+
+            StageTimer publishTimer(latency_.Histogram(LatencyStage::Publish));
+
+            // Broadcast the book to every consumer, diffed against the last book published for its venue
+            auto previous = venueBooks_.find(book.venue);
+            StampBook(book, books_.Latest(), previous != venueBooks_.end() ? &previous->second : nullptr);
+            uint64_t sequence = book.sequence;
+            std::string venue = book.venue;
+            venueScratch_.asks.assign(book.asks.begin(), book.asks.end());
+            venueScratch_.bids.assign(book.bids.begin(), book.bids.end());
+            venueScratch_.askTailSize = book.askTailSize;
+            venueScratch_.bidTailSize = book.bidTailSize;
+            if (!books_.Publish(std::move(book))) {
+                if (!books_.Closed()) {
+                    Logger::Log("Book ring full; dropping book.", "WARNING");
+                }
+                return;
+            }
+            std::swap(venueBooks_[venue], venueScratch_);
+            Logger::Event(LogEvent::BookPublished, sequence);
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Data processing error");
+        }
+    }
+
+    // Thread-safe. Override the ingest depth for a single instrument (0 keeps every level); applies from the next
+    // book the strand parses
+    void SetMaxDepth(std::string symbol, size_t levels) {
+        boost::asio::post(strand_, [this, symbol = std::move(symbol), levels]() {
+            depthLimits_[symbol] = levels;
+            });
+    }
+
+    // Strand only, like ProcessData
+    size_t GetMaxDepth(const std::string& symbol) const {
+        auto it = depthLimits_.find(symbol);
+        return it != depthLimits_.end() ? it->second : CONFIG_MAX_DEPTH;
+    }
+
+private:
+    using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    boost::asio::awaitable<void> Run() {
+        auto backoff = std::chrono::milliseconds(CONFIG_RETRY_INITIAL_BACKOFF_MS);
+        const auto maxBackoff = std::chrono::milliseconds(CONFIG_RETRY_INTERVAL * 1000);
+
+        while (!stopping_) {
+            try {
+                co_await Connect();
+                backoff = std::chrono::milliseconds(CONFIG_RETRY_INITIAL_BACKOFF_MS);
+
+                uint64_t connection = ++connection_;
+                boost::asio::co_spawn(strand_, Heartbeat(connection), boost::asio::detached);
+                co_await ReadLoop();
+            }
+            catch (const std::exception& e) {
+                if (!stopping_) {
+                    ExceptionHandler::HandleException(e, "WebSocket session error");
+                }
+            }
+
+            // Stop the heartbeat of the dropped connection; its unsent messages are replayed as subscriptions
+            ++connection_;
+            pingTimer_.cancel();
+            connected_ = false;
+            outbox_.clear();
+            if (stopping_) {
+                break;
+            }
+
+            // Reconnect after a backoff that doubles up to CONFIG_RETRY_INTERVAL
+            retryTimer_.expires_after(backoff);
+            beast::error_code ec;
+            co_await retryTimer_.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            backoff = std::min(backoff * 2, maxBackoff);
+        }
+    }
+
+    boost::asio::awaitable<void> Connect() {
+        // The previous connection's writer or heartbeat may still have a write or ping pending on the old stream.
+        // Abort its socket and wait for them to return before the stream is replaced.
+        if (ws_) {
+            beast::error_code ec;
+            beast::get_lowest_layer(*ws_).socket().close(ec);
+        }
+        while (writing_ || pinging_) {
+            streamIdle_.expires_at(boost::asio::steady_timer::time_point::max());
+            beast::error_code ec;
+            co_await streamIdle_.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        }
+        ThrowIfStopping();
+        ws_.emplace(strand_);
+
+        // Resolve the domain name
+        auto const results = co_await resolver_.async_resolve(endpoint_.host, endpoint_.port, boost::asio::use_awaitable);
+        ThrowIfStopping();
+
+        // Make the connection on the IP address we get from a lookup
+        beast::get_lowest_layer(*ws_).expires_after(std::chrono::seconds(CONFIG_RETRY_INTERVAL));
+        co_await beast::get_lowest_layer(*ws_).async_connect(results, boost::asio::use_awaitable);
+        beast::get_lowest_layer(*ws_).expires_never();
+        ThrowIfStopping();
+
+        // Perform the WebSocket handshake
+        websocket::stream_base::timeout timeout = websocket::stream_base::timeout::suggested(beast::role_type::client);
+        timeout.handshake_timeout = std::chrono::seconds(CONFIG_RETRY_INTERVAL);
+        ws_->set_option(timeout);
+        co_await ws_->async_handshake(endpoint_.host, endpoint_.path, boost::asio::use_awaitable);
+        ThrowIfStopping();
+
+        Logger::Log("WebSocket connection established successfully.");
+
+        // Resubscribe through the writer, so these never overlap a subscription added meanwhile
+        connected_ = true;
+        outbox_.assign(subscriptions_.begin(), subscriptions_.end());
+        StartWriting();
+    }
+
+    // Stop() only cancels the operation pending when it runs, so a suspended Connect re-checks after every await
+    void ThrowIfStopping() const {
+        if (stopping_) {
+            throw beast::system_error(boost::asio::error::operation_aborted);
+        }
+    }
+
+    boost::asio::awaitable<void> ReadLoop() {
+        while (!stopping_) {
+            buffer_.clear();
+            co_await ws_->async_read(buffer_, boost::asio::use_awaitable);
+            ProcessData(buffer_, LatencyMonitor::NowNs());
+        }
+    }
+
+    boost::asio::awaitable<void> Heartbeat(uint64_t connection) {
+        try {
+            while (connection == connection_ && !stopping_) {
+                pingTimer_.expires_after(std::chrono::seconds(CONFIG_PING_INTERVAL));
+                beast::error_code ec;
+                co_await pingTimer_.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+                if (ec || connection != connection_ || stopping_) {
+                    co_return;
+                }
+
+                pinging_ = true;
+                co_await ws_->async_ping("heartbeat", boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+                pinging_ = false;
+                streamIdle_.cancel();
+                if (ec) {
+                    throw beast::system_error(ec);
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Ping error");
+        }
+    }
+
+    // Strand only. Spawns the writer unless it is already running; it picks up anything queued meanwhile
+    void StartWriting() {
+        if (!writing_ && !outbox_.empty()) {
+            writing_ = true;
+            boost::asio::co_spawn(strand_, WriteLoop(), boost::asio::detached);
+        }
+    }
+
+    // The only coroutine that writes data frames, one at a time; a write that fails on a dropped connection
+    // is not retried since Connect replays the subscriptions
+    boost::asio::awaitable<void> WriteLoop() {
+        while (connected_ && !outbox_.empty()) {
+            std::string message = std::move(outbox_.front());
+            outbox_.pop_front();
+
+            beast::error_code ec;
+            co_await ws_->async_write(boost::asio::buffer(message), boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            if (ec && ec != boost::asio::error::operation_aborted && !stopping_) {
+                ExceptionHandler::HandleException(beast::system_error(ec), "WebSocket write error");
+            }
+        }
+        writing_ = false;
+        streamIdle_.cancel();
+    }
+
+    // Closing handshake, waiting at most a second for the peer's reply
+    boost::asio::awaitable<void> Close() {
+        websocket::stream_base::timeout timeout = websocket::stream_base::timeout::suggested(beast::role_type::client);
+        timeout.handshake_timeout = std::chrono::seconds(1);
+        ws_->set_option(timeout);
+
+        beast::error_code ec;
+        co_await ws_->async_close(websocket::close_code::normal, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        if (ec && ec != boost::asio::error::operation_aborted) {
+            ExceptionHandler::HandleException(beast::system_error(ec), "Close error");
+        }
+    }
+
+    bool ValidateJson(const std::string& json_str) {
+        try {
+            auto json = nlohmann::json::parse(json_str);
+            if (!json.contains("symbol") || !json.contains("asks") || !json.contains("bids")) {
+                return false;
+            }
+            return true;
+        }
+        catch (...) {
+            return false;
+        }
+    }
+
+    Strand strand_;
+    tcp::resolver resolver_;
+    std::optional<websocket::stream<beast::tcp_stream>> ws_; // Recreated for every connection
+    beast::flat_buffer buffer_;
+    boost::asio::steady_timer retryTimer_;
+    boost::asio::steady_timer pingTimer_;
+    boost::asio::steady_timer streamIdle_; // Cancelled when WriteLoop returns or a ping completes, to wake Connect
+    uint64_t connection_ = 0; // Incremented when a connection starts or ends
+    bool connected_ = false; // Handshake done and the connection not yet dropped
+    bool writing_ = false; // WriteLoop is running
+    bool pinging_ = false; // Heartbeat has a ping pending
+    std::deque<std::string> outbox_; // Messages waiting for WriteLoop
+    std::vector<std::string> subscriptions_;
+    std::unordered_map<std::string, size_t> depthLimits_;
+    std::unordered_map<std::string, OrderBook> venueBooks_; // Levels of the last book published per venue
+    OrderBook venueScratch_; // Reused copy of the book being published
+    const FeedEndpoint& endpoint_;
+    BroadcastRing<OrderBook>& books_;
+    LatencyMonitor& latency_;
+    const std::atomic<bool>& stopping_;
+};
+
+// SIMD Kernels
+// AVX-512 / AVX2 kernels with scalar fallbacks, selected once at runtime from the host CPU
+static_assert(sizeof(std::pair<double, double>) == 2 * sizeof(double),
+    "Price levels must be two packed doubles for the SIMD kernels");
+
+enum class SimdLevel { Scalar = 0, AVX2 = 1, AVX512 = 2 };
+
+namespace simd_detail {
+
+    inline double ExpScalar(double x) { return std::exp(x); }
+
+    inline double LevelNotionalScalar(const double* levels, size_t count) {
+        double notional = 0;
+        for (size_t i = 0; i < count; ++i) {
+            notional += levels[2 * i] * levels[2 * i + 1];
+        }
+        return notional;
+    }
+
+    inline double LevelDepthScalar(const double* levels, size_t count) {
+        double depth = 0;
+        for (size_t i = 0; i < count; ++i) {
+            depth += levels[2 * i + 1];
+        }
+        return depth;
+    }
+
+    inline double DotScalar(const double* a, const double* b, size_t count) {
+        double dot = 0;
+        for (size_t i = 0; i < count; ++i) {
+            dot += a[i] * b[i];
+        }
+        return dot;
+    }
+
+    inline void MarketImpactScalar(const double* quantities, const double* volatilities, size_t count,
+        double eta, double gamma, double timeHorizon, double* out) {
+        double invSqrtHorizon = 1.0 / std::sqrt(timeHorizon);
+        for (size_t i = 0; i < count; ++i) {
+            double q = quantities[i];
+            out[i] = eta * q + gamma * q * q + volatilities[i] * std::sqrt(q) * invSqrtHorizon;
+        }
+    }
+
+    inline void SigmoidScalar(const double* logits, size_t count, double* out) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = 1 / (1 + ExpScalar(-logits[i]));
+        }
+    }
+
+#if TRADE_SIM_X86_SIMD
+    // exp(x) = 2^n * exp(r) with r in [-ln2/2, ln2/2] and a degree 11 Taylor polynomial (~1e-14 relative error)
+    __attribute__((target("avx2,fma"))) inline __m256d ExpAVX2(__m256d x) {
+        x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-708.0)), _mm256_set1_pd(708.0));
+        __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634)),
+            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(6.93147180369123816490e-01), x);
+        r = _mm256_fnmadd_pd(n, _mm256_set1_pd(1.90821492927058770002e-10), r);
+
+        __m256d p = _mm256_set1_pd(1.0 / 39916800.0);
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 3628800.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 362880.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 40320.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 5040.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 720.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 120.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 24.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 6.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(0.5));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+
+        // Build 2^n directly in the exponent bits
+        __m256i exponent = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+        exponent = _mm256_slli_epi64(_mm256_add_epi64(exponent, _mm256_set1_epi64x(1023)), 52);
+        return _mm256_mul_pd(p, _mm256_castsi256_pd(exponent));
+    }
+
+    __attribute__((target("avx2,fma"))) inline double LevelNotionalAVX2(const double* levels, size_t count) {
+        // [p0 s0 p1 s1] * [s0 p0 s1 p1] accumulates every price * size twice
+        __m256d acc = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m256d v = _mm256_loadu_pd(levels + 2 * i);
+            acc = _mm256_fmadd_pd(v, _mm256_permute_pd(v, 0x5), acc);
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, acc);
+        double notional = 0.5 * (lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+        return notional + LevelNotionalScalar(levels + 2 * i, count - i);
+    }
+
+    __attribute__((target("avx2,fma"))) inline double LevelDepthAVX2(const double* levels, size_t count) {
+        // Sizes sit in the odd lanes of [p0 s0 p1 s1]
+        __m256d acc = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            acc = _mm256_add_pd(acc, _mm256_loadu_pd(levels + 2 * i));
+        }
+        __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        return _mm_cvtsd_f64(_mm_unpackhi_pd(pair, pair)) + LevelDepthScalar(levels + 2 * i, count - i);
+    }
+
+    __attribute__((target("avx2,fma"))) inline double DotAVX2(const double* a, const double* b, size_t count) {
+        __m256d acc = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc);
+        }
+        __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair))) + DotScalar(a + i, b + i, count - i);
+    }
+
+    __attribute__((target("avx2,fma"))) inline void MarketImpactAVX2(const double* quantities, const double* volatilities,
+        size_t count, double eta, double gamma, double timeHorizon, double* out) {
+        __m256d vEta = _mm256_set1_pd(eta);
+        __m256d vGamma = _mm256_set1_pd(gamma);
+        __m256d vInvSqrtHorizon = _mm256_set1_pd(1.0 / std::sqrt(timeHorizon));
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m256d q = _mm256_loadu_pd(quantities + i);
+            __m256d v = _mm256_loadu_pd(volatilities + i);
+            __m256d impact = _mm256_mul_pd(q, _mm256_fmadd_pd(vGamma, q, vEta));
+            impact = _mm256_fmadd_pd(_mm256_mul_pd(v, _mm256_sqrt_pd(q)), vInvSqrtHorizon, impact);
+            _mm256_storeu_pd(out + i, impact);
+        }
+        MarketImpactScalar(quantities + i, volatilities + i, count - i, eta, gamma, timeHorizon, out + i);
+    }
+
+    __attribute__((target("avx2,fma"))) inline void SigmoidAVX2(const double* logits, size_t count, double* out) {
+        __m256d one = _mm256_set1_pd(1.0);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m256d z = _mm256_loadu_pd(logits + i);
+            __m256d e = ExpAVX2(_mm256_sub_pd(_mm256_setzero_pd(), z));
+            _mm256_storeu_pd(out + i, _mm256_div_pd(one, _mm256_add_pd(one, e)));
+        }
+        SigmoidScalar(logits + i, count - i, out + i);
+    }
+
+    // GCC 12's avx512fintrin.h seeds masked builtins with a self-initialised _mm512_undefined_pd(), which warns
+    // as uninitialised wherever the intrinsics inline
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    __attribute__((target("avx512f"))) inline __m512d ExpAVX512(__m512d x) {
+        x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(-708.0)), _mm512_set1_pd(708.0));
+        __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(1.4426950408889634)),
+            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(6.93147180369123816490e-01), x);
+        r = _mm512_fnmadd_pd(n, _mm512_set1_pd(1.90821492927058770002e-10), r);
+
+        __m512d p = _mm512_set1_pd(1.0 / 39916800.0);
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 3628800.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 362880.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 40320.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 5040.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 720.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 120.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 24.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 6.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(0.5));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0));
+
+        return _mm512_scalef_pd(p, n);
+    }
+
+    __attribute__((target("avx512f"))) inline double LevelNotionalAVX512(const double* levels, size_t count) {
+        __m512d acc = _mm512_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m512d v = _mm512_loadu_pd(levels + 2 * i);
+            acc = _mm512_fmadd_pd(v, _mm512_permute_pd(v, 0x55), acc);
+        }
+        // Fold 512 -> 256 -> 128 -> 64 bits by hand
+        __m256d half = _mm256_add_pd(_mm512_castpd512_pd256(acc), _mm512_extractf64x4_pd(acc, 1));
+        __m128d quarter = _mm_add_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+        double notional = 0.5 * _mm_cvtsd_f64(_mm_add_sd(quarter, _mm_unpackhi_pd(quarter, quarter)));
+        return notional + LevelNotionalScalar(levels + 2 * i, count - i);
+    }
+
+    __attribute__((target("avx512f"))) inline double LevelDepthAVX512(const double* levels, size_t count) {
+        __m512d acc = _mm512_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            acc = _mm512_add_pd(acc, _mm512_loadu_pd(levels + 2 * i));
+        }
+        // Folding halves keeps sizes in the odd lanes, so lane 1 of the last fold holds their sum
+        __m256d half = _mm256_add_pd(_mm512_castpd512_pd256(acc), _mm512_extractf64x4_pd(acc, 1));
+        __m128d quarter = _mm_add_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+        return _mm_cvtsd_f64(_mm_unpackhi_pd(quarter, quarter)) + LevelDepthScalar(levels + 2 * i, count - i);
+    }
+
+    __attribute__((target("avx512f"))) inline double DotAVX512(const double* a, const double* b, size_t count) {
+        __m512d acc = _mm512_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            acc = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc);
+        }
+        __m256d half = _mm256_add_pd(_mm512_castpd512_pd256(acc), _mm512_extractf64x4_pd(acc, 1));
+        __m128d quarter = _mm_add_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(quarter, _mm_unpackhi_pd(quarter, quarter))) + DotScalar(a + i, b + i, count - i);
+    }
+
+    __attribute__((target("avx512f"))) inline void MarketImpactAVX512(const double* quantities, const double* volatilities,
+        size_t count, double eta, double gamma, double timeHorizon, double* out) {
+        __m512d vEta = _mm512_set1_pd(eta);
+        __m512d vGamma = _mm512_set1_pd(gamma);
+        __m512d vInvSqrtHorizon = _mm512_set1_pd(1.0 / std::sqrt(timeHorizon));
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m512d q = _mm512_loadu_pd(quantities + i);
+            __m512d v = _mm512_loadu_pd(volatilities + i);
+            __m512d impact = _mm512_mul_pd(q, _mm512_fmadd_pd(vGamma, q, vEta));
+            impact = _mm512_fmadd_pd(_mm512_mul_pd(v, _mm512_sqrt_pd(q)), vInvSqrtHorizon, impact);
+            _mm512_storeu_pd(out + i, impact);
+        }
+        MarketImpactScalar(quantities + i, volatilities + i, count - i, eta, gamma, timeHorizon, out + i);
+    }
+
+    __attribute__((target("avx512f"))) inline void SigmoidAVX512(const double* logits, size_t count, double* out) {
+        __m512d one = _mm512_set1_pd(1.0);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m512d z = _mm512_loadu_pd(logits + i);
+            __m512d e = ExpAVX512(_mm512_sub_pd(_mm512_setzero_pd(), z));
+            _mm512_storeu_pd(out + i, _mm512_div_pd(one, _mm512_add_pd(one, e)));
+        }
+        SigmoidScalar(logits + i, count - i, out + i);
+    }
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace simd_detail
+
+class SimdKernels {
+public:
+    static SimdLevel Level() {
+        static const SimdLevel level = DetectLevel();
+        return level;
+    }
+
+    // Sum of price * size over the first count levels
+    static double LevelNotional(const std::pair<double, double>* levels, size_t count) {
+        const double* data = reinterpret_cast<const double*>(levels);
+#if TRADE_SIM_X86_SIMD
+        switch (Level()) {
+        case SimdLevel::AVX512: return simd_detail::LevelNotionalAVX512(data, count);
+        case SimdLevel::AVX2: return simd_detail::LevelNotionalAVX2(data, count);
+        default: break;
+        }
+#endif
+        return simd_detail::LevelNotionalScalar(data, count);
+    }
+
+    // Sum of size over the first count levels
+    static double LevelDepth(const std::pair<double, double>* levels, size_t count) {
+        const double* data = reinterpret_cast<const double*>(levels);
+#if TRADE_SIM_X86_SIMD
+        switch (Level()) {
+        case SimdLevel::AVX512: return simd_detail::LevelDepthAVX512(data, count);
+        case SimdLevel::AVX2: return simd_detail::LevelDepthAVX2(data, count);
+        default: break;
+        }
+#endif
+        return simd_detail::LevelDepthScalar(data, count);
+    }
+
+    // Sum of a[i] * b[i]
+    static double Dot(const double* a, const double* b, size_t count) {
+#if TRADE_SIM_X86_SIMD
+        switch (Level()) {
+        case SimdLevel::AVX512: return simd_detail::DotAVX512(a, b, count);
+        case SimdLevel::AVX2: return simd_detail::DotAVX2(a, b, count);
+        default: break;
+        }
+#endif
+        return simd_detail::DotScalar(a, b, count);
+    }
+
+    // out[i] = eta * q + gamma * q^2 + volatility * sqrt(q) / sqrt(timeHorizon)
+    static void MarketImpact(const double* quantities, const double* volatilities, size_t count,
+        double eta, double gamma, double timeHorizon, double* out) {
+#if TRADE_SIM_X86_SIMD
+        switch (Level()) {
+        case SimdLevel::AVX512: return simd_detail::MarketImpactAVX512(quantities, volatilities, count, eta, gamma, timeHorizon, out);
+        case SimdLevel::AVX2: return simd_detail::MarketImpactAVX2(quantities, volatilities, count, eta, gamma, timeHorizon, out);
+        default: break;
+        }
+#endif
+        simd_detail::MarketImpactScalar(quantities, volatilities, count, eta, gamma, timeHorizon, out);
+    }
+
+    // out[i] = 1 / (1 + exp(-logits[i]))
+    static void Sigmoid(const double* logits, size_t count, double* out) {
+#if TRADE_SIM_X86_SIMD
+        switch (Level()) {
+        case SimdLevel::AVX512: return simd_detail::SigmoidAVX512(logits, count, out);
+        case SimdLevel::AVX2: return simd_detail::SigmoidAVX2(logits, count, out);
+        default: break;
+        }
+#endif
+        simd_detail::SigmoidScalar(logits, count, out);
+    }
+
+private:
+    static SimdLevel DetectLevel() {
+        SimdLevel level = SimdLevel::Scalar;
+#if TRADE_SIM_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            level = SimdLevel::AVX512;
+        }
+        else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            level = SimdLevel::AVX2;
+        }
+#endif
+        return std::min(level, static_cast<SimdLevel>(CONFIG_SIMD_MAX_LEVEL));
+    }
+};
+
+// Almgren-Chriss Optimal Execution
+// Liquidation of quantity over timeHorizon in equal slices; volatility is the absolute price volatility per unit time
+struct AlmgrenChrissParams {
+    double quantity = CONFIG_DEFAULT_QUANTITY;
+    double volatility = CONFIG_DEFAULT_VOLATILITY;
+    double eta = CONFIG_IMPACT_ETA; // Temporary market impact coefficient
+    double gamma = CONFIG_IMPACT_GAMMA; // Permanent market impact coefficient
+    double epsilon = 0.0; // Fixed cost per unit traded (half spread plus fees)
+    double riskAversion = CONFIG_RISK_AVERSION; // Lambda
+    double timeHorizon = CONFIG_IMPACT_TIME_HORIZON;
+    int slices = CONFIG_EXECUTION_SLICES;
+};
+
+struct ExecutionPlan {
+    std::vector<double> holdings; // x_0 .. x_N, remaining quantity after each slice
+    std::vector<double> trades; // n_1 .. n_N, quantity executed in each slice
+    double expectedCost = 0.0;
+    double variance = 0.0;
+};
+
+struct FrontierPoint {
+    double timeHorizon = 0.0;
+    double riskAversion = 0.0;
+    double expectedCost = 0.0;
+    double variance = 0.0;
+};
+
+class AlmgrenChrissModel {
+public:
+    explicit AlmgrenChrissModel(const AlmgrenChrissParams& params) : params_(params) {
+        if (params.quantity <= 0) throw std::invalid_argument("Quantity must be positive");
+        if (params.volatility < 0) throw std::invalid_argument("Volatility cannot be negative");
+        if (params.riskAversion < 0) throw std::invalid_argument("Risk aversion cannot be negative");
+        if (params.slices < 1) throw std::invalid_argument("Slices must be at least 1");
+        terms_ = ComputeTerms(params.timeHorizon);
+    }
+
+    // Optimal holdings x_j = X sinh(kappa (T - t_j)) / sinh(kappa T)
+    ExecutionPlan Schedule() const {
+        ExecutionPlan plan;
+        plan.holdings.resize(params_.slices + 1);
+        plan.trades.resize(params_.slices);
+
+        for (int j = 0; j <= params_.slices; ++j) {
+            plan.holdings[j] = Holding(terms_, j);
+        }
+        for (int j = 0; j < params_.slices; ++j) {
+            plan.trades[j] = plan.holdings[j] - plan.holdings[j + 1];
+        }
+
+        plan.expectedCost = ExpectedCost(terms_);
+        plan.variance = Variance(terms_);
+        return plan;
+    }
+
+    double ExpectedCost() const { return ExpectedCost(terms_); }
+    double Variance() const { return Variance(terms_); }
+
+    // Cost and variance of the optimal schedule for each horizon, keeping quantity, slices and risk aversion
+    std::vector<FrontierPoint> EvaluateHorizons(const std::vector<double>& horizons) const {
+        std::vector<FrontierPoint> points;
+        points.reserve(horizons.size());
+        for (double horizon : horizons) {
+            Terms terms = horizon == params_.timeHorizon ? terms_ : ComputeTerms(horizon);
+            points.push_back({ horizon, params_.riskAversion, ExpectedCost(terms), Variance(terms) });
+        }
+        return points;
+    }
+
+    // Efficient frontier: optimal cost and variance for each risk aversion at the configured horizon
+    static std::vector<FrontierPoint> EfficientFrontier(AlmgrenChrissParams params, const std::vector<double>& riskAversions) {
+        std::vector<FrontierPoint> points;
+        points.reserve(riskAversions.size());
+        for (double riskAversion : riskAversions) {
+            params.riskAversion = riskAversion;
+            AlmgrenChrissModel model(params);
+            points.push_back({ params.timeHorizon, riskAversion, model.ExpectedCost(), model.Variance() });
+        }
+        return points;
+    }
+
+private:
+    // Closed-form terms shared by the trajectory, cost and variance for one horizon. The hyperbolic functions only
+    // appear as ratios, kept in exponentially scaled form so they stay finite for any kappa T.
+    struct Terms {
+        double timeHorizon = 0.0;
+        double tau = 0.0; // Slice length
+        double etaTilde = 0.0; // Temporary impact net of the permanent impact discretisation
+        double kappa = 0.0; // Urgency; 0 is the linear (TWAP) limit
+        double tanhHalfKappaTau = 0.0;
+        double cothKappaT = 0.0;
+        double sinhTauOverSinhSqT = 0.0; // sinh(kappa tau) / sinh^2(kappa T)
+        double invSinhSqT = 0.0; // 1 / sinh^2(kappa T)
+        double coshOverSinhSinh = 0.0; // cosh(kappa (T - tau)) / (sinh(kappa T) sinh(kappa tau))
+    };
+
+    // sinh(x) / sinh(y) for 0 <= x <= y, y > 0
+    static double SinhRatio(double x, double y) {
+        return std::exp(x - y) * std::expm1(-2 * x) / std::expm1(-2 * y);
+    }
+
+    // 1 / sinh(x) for x > 0
+    static double InvSinh(double x) {
+        return -2 * std::exp(-x) / std::expm1(-2 * x);
+    }
+
+    Terms ComputeTerms(double timeHorizon) const {
+        if (timeHorizon <= 0) throw std::invalid_argument("Time horizon must be positive");
+
+        Terms terms;
+        terms.timeHorizon = timeHorizon;
+        terms.tau = timeHorizon / params_.slices;
+        terms.etaTilde = params_.eta - 0.5 * params_.gamma * terms.tau;
+        if (terms.etaTilde <= 0) throw std::invalid_argument("Temporary impact too small for the slice length");
+
+        double kappaTildeSq = params_.riskAversion * params_.volatility * params_.volatility / terms.etaTilde;
+        terms.kappa = std::acosh(0.5 * kappaTildeSq * terms.tau * terms.tau + 1) / terms.tau;
+
+        double kT = terms.kappa * timeHorizon;
+        double kTau = terms.kappa * terms.tau;
+        if (kT < 1e-8) {
+            return terms;
+        }
+        terms.tanhHalfKappaTau = std::tanh(0.5 * kTau);
+        terms.cothKappaT = 1 / std::tanh(kT);
+        terms.invSinhSqT = InvSinh(kT) * InvSinh(kT);
+        terms.sinhTauOverSinhSqT = SinhRatio(kTau, kT) * InvSinh(kT);
+        terms.coshOverSinhSinh = 2 * std::exp(-2 * kTau) * (1 + std::exp(-2 * (kT - kTau)))
+            / (std::expm1(-2 * kT) * std::expm1(-2 * kTau));
+        return terms;
+    }
+
+    // Only for kappa T near zero, where the sinh ratios become 0 / 0
+    bool IsLinear(const Terms& terms) const {
+        return terms.kappa * terms.timeHorizon < 1e-8;
+    }
+
+    double Holding(const Terms& terms, int slice) const {
+        double X = params_.quantity;
+        if (slice >= params_.slices) return 0.0;
+        if (IsLinear(terms)) return X * (1.0 - static_cast<double>(slice) / params_.slices);
+        return X * SinhRatio(terms.kappa * (terms.timeHorizon - slice * terms.tau), terms.kappa * terms.timeHorizon);
+    }
+
+    double ExpectedCost(const Terms& terms) const {
+        double X = params_.quantity;
+        double fixed = 0.5 * params_.gamma * X * X + params_.epsilon * X;
+        if (IsLinear(terms)) {
+            return fixed + terms.etaTilde * X * X / terms.timeHorizon;
+        }
+        // tanh(k tau / 2) (tau sinh(2 k T) + 2 T sinh(k tau)) / (2 tau^2 sinh^2(k T)), with sinh(2a) = 2 sinh(a) cosh(a)
+        return fixed + terms.etaTilde * X * X * terms.tanhHalfKappaTau
+            * (terms.cothKappaT / terms.tau + terms.timeHorizon * terms.sinhTauOverSinhSqT / (terms.tau * terms.tau));
+    }
+
+    double Variance(const Terms& terms) const {
+        double X = params_.quantity;
+        double sigmaSq = params_.volatility * params_.volatility;
+        if (IsLinear(terms)) {
+            double N = params_.slices;
+            return sigmaSq * X * X * terms.timeHorizon * (1 - 1 / N) * (1 - 1 / (2 * N)) / 3;
+        }
+        // (tau sinh(k T) cosh(k (T - tau)) - T sinh(k tau)) / (sinh^2(k T) sinh(k tau)), split into the two ratios
+        return 0.5 * sigmaSq * X * X * (terms.tau * terms.coshOverSinhSinh - terms.timeHorizon * terms.invSinhSqT);
+    }
+
+    AlmgrenChrissParams params_;
+    Terms terms_;
+};
+
+// Parallel Execution
+// Bump allocator for per-job temporaries. Blocks are kept when memory is released, so steady-state jobs never
+// call malloc; Scope releases everything allocated during its lifetime. Only trivially destructible types.
+class ScratchArena {
+public:
+    explicit ScratchArena(size_t blockSize = CONFIG_SCRATCH_ARENA_BYTES) : blockSize_(blockSize) {}
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    template <typename T>
+    T* Allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena memory is released without destructors");
+        size_t bytes = count * sizeof(T);
+        while (true) {
+            if (block_ < blocks_.size()) {
+                Block& block = blocks_[block_];
+                size_t aligned = (offset_ + alignof(T) - 1) / alignof(T) * alignof(T);
+                if (aligned + bytes <= block.size) {
+                    offset_ = aligned + bytes;
+                    return reinterpret_cast<T*>(block.data.get() + aligned);
+                }
+                ++block_;
+                offset_ = 0;
+                continue;
+            }
+            size_t size = std::max(blockSize_, bytes + alignof(std::max_align_t));
+            blocks_.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+        }
+    }
+
+    // Releases on destruction everything allocated since construction
+    class Scope {
+    public:
+        explicit Scope(ScratchArena& arena) : arena_(arena), block_(arena.block_), offset_(arena.offset_) {}
+        ~Scope() {
+            arena_.block_ = block_;
+            arena_.offset_ = offset_;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ScratchArena& arena_;
+        size_t block_;
+        size_t offset_;
+    };
+
+    size_t Capacity() const {
+        size_t capacity = 0;
+        for (const Block& block : blocks_) capacity += block.size;
+        return capacity;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    size_t blockSize_;
+    std::vector<Block> blocks_;
+    size_t block_ = 0; // Block currently allocated from
+    size_t offset_ = 0;
+};
+
+// Work-stealing executor. Each worker owns a deque: it pushes and pops its own jobs at the back (most recent,
+// still in cache) and idle workers steal from the front of the others (oldest). A deque's mutex is only contended
+// between its owner and a thief. Each worker has a scratch arena; idle workers sleep on a futex.
+class WorkStealingPool {
+public:
+    using Job = std::function<void()>;
+
+    explicit WorkStealingPool(size_t threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        stopping_.store(true, std::memory_order_release);
+        signal_.fetch_add(1, std::memory_order_release);
+        signal_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queues a job on the calling worker's deque, or round robin when called from outside the pool
+    void Execute(Job job) {
+        size_t queue = currentPool_ == this
+            ? currentWorker_
+            : nextQueue_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        {
+            std::lock_guard<std::mutex> lock(workers_[queue]->mutex);
+            workers_[queue]->jobs.push_back(std::move(job));
+        }
+        pending_.fetch_add(1, std::memory_order_release);
+        signal_.fetch_add(1, std::memory_order_release);
+        signal_.notify_one();
+    }
+
+    // Queues f() and returns its result (or exception) through a future
+    template <typename F>
+    auto Submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        using Result = std::invoke_result_t<std::decay_t<F>&>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        std::future<Result> result = task->get_future();
+        Execute([task]() { (*task)(); });
+        return result;
+    }
+
+    // Runs task(index) for every index in [0, count) on up to parallelism workers (0 = the whole pool plus the
+    // caller), handing out indices dynamically so uneven tasks balance. The caller only works on this loop's
+    // indices; once they are all handed out it sleeps until the helpers still inside task() return. A helper that
+    // starts after that finds no index and exits at once, so the caller never waits on queued or unrelated jobs
+    // and nested calls cannot deadlock. Rethrows the first exception.
+    template <typename Task>
+    void ParallelFor(size_t count, Task&& task, size_t parallelism = 0) {
+        if (parallelism == 0) parallelism = workers_.size() + 1;
+        parallelism = std::min(parallelism, count);
+        if (parallelism <= 1) {
+            for (size_t i = 0; i < count; ++i) task(i);
+            return;
+        }
+
+        // Shared with the helper jobs, which may outlive this call; task is only touched while an index is left
+        struct Loop {
+            std::atomic<size_t> next{ 0 };
+            std::atomic<uint32_t> active{ 0 }; // Helpers inside Drain
+            std::exception_ptr error;
+            std::mutex errorMutex;
+        };
+        auto loop = std::make_shared<Loop>();
+        auto* body = &task;
+        auto drain = [count, body](Loop& state) {
+            try {
+                for (size_t i = state.next.fetch_add(1); i < count; i = state.next.fetch_add(1)) {
+                    (*body)(i);
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(state.errorMutex);
+                if (!state.error) state.error = std::current_exception();
+                state.next.store(count);
+            }
+        };
+
+        for (size_t h = 1; h < parallelism; ++h) {
+            Execute([loop, drain]() {
+                // Announce before taking an index, so the caller cannot miss a helper that got one
+                loop->active.fetch_add(1);
+                drain(*loop);
+                loop->active.fetch_sub(1, std::memory_order_release);
+                loop->active.notify_all();
+            });
+        }
+        drain(*loop);
+        for (uint32_t active = loop->active.load(); active > 0; active = loop->active.load()) {
+            loop->active.wait(active, std::memory_order_acquire);
+        }
+
+        if (loop->error) {
+            std::rethrow_exception(loop->error);
+        }
+    }
+
+    size_t Size() const { return workers_.size(); }
+
+    // Scratch arena of the calling pool worker, or a thread-local arena for other threads
+    static ScratchArena& Scratch() {
+        if (currentPool_) {
+            return currentPool_->workers_[currentWorker_]->arena;
+        }
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+    // Process-wide pool of CONFIG_WORKER_POOL_THREADS workers
+    static WorkStealingPool& Default() {
+        static WorkStealingPool pool(CONFIG_WORKER_POOL_THREADS);
+        return pool;
+    }
+
+private:
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        ScratchArena arena;
+    };
+
+    // Runs one job: the back of self's deque, else the front of another's. Returns false if none was found.
+    bool RunOne(size_t self) {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(workers_[self]->mutex);
+            if (!workers_[self]->jobs.empty()) {
+                job = std::move(workers_[self]->jobs.back());
+                workers_[self]->jobs.pop_back();
+            }
+        }
+        for (size_t i = 1; !job && i < workers_.size(); ++i) {
+            Worker& worker = *workers_[(self + i) % workers_.size()];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (!worker.jobs.empty()) {
+                job = std::move(worker.jobs.front());
+                worker.jobs.pop_front();
+            }
+        }
+        if (!job) {
+            return false;
+        }
+
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        job();
+        return true;
+    }
+
+    void WorkerLoop(size_t index) {
+        std::string name = "ts-pool-" + std::to_string(index);
+        ConfigureCurrentThread(name.c_str(), -1);
+        currentPool_ = this;
+        currentWorker_ = index;
+
+        while (true) {
+            if (RunOne(index)) {
+                continue;
+            }
+            uint32_t ticket = signal_.load(std::memory_order_acquire);
+            if (pending_.load(std::memory_order_acquire) > 0) {
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire)) {
+                return;
+            }
+            signal_.wait(ticket, std::memory_order_acquire);
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    alignas(64) std::atomic<size_t> pending_{ 0 }; // Queued jobs not yet taken
+    std::atomic<uint32_t> signal_{ 0 };
+    std::atomic<bool> stopping_{ false };
+    std::atomic<size_t> nextQueue_{ 0 };
+
+    static inline thread_local WorkStealingPool* currentPool_ = nullptr;
+    static inline thread_local size_t currentWorker_ = 0;
+};
+
+// Runs task(index) for every index in [0, count) on the default pool with up to threads workers (0 = all);
+// the calling thread is one of the workers
+template <typename Task>
+void ParallelFor(size_t count, Task&& task, size_t threads = 0) {
+    WorkStealingPool::Default().ParallelFor(count, std::forward<Task>(task), threads);
+}
+
+// Counter-Based Random Numbers
+// Philox4x32-10: the output is a pure function of (counter, key), so every path draws from its own stream
+// regardless of which thread runs it
+class Philox4x32 {
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    static Block Generate(Block counter, uint64_t key) {
+        uint32_t k0 = static_cast<uint32_t>(key);
+        uint32_t k1 = static_cast<uint32_t>(key >> 32);
+        for (int round = 0; round < 10; ++round) {
+            uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+            uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+            counter = { static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ k0, static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ k1, static_cast<uint32_t>(p0) };
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        return counter;
+    }
+
+    // Two independent standard normals (Box-Muller) from one block
+    static std::pair<double, double> Normals(const Block& block) {
+        const double twoPi = 6.283185307179586;
+        double u1 = ToUnit(block[0], block[1]);
+        double u2 = ToUnit(block[2], block[3]);
+        double radius = std::sqrt(-2.0 * std::log(u1));
+        return { radius * std::cos(twoPi * u2), radius * std::sin(twoPi * u2) };
+    }
+
+private:
+    // 53-bit uniform in (0, 1]
+    static double ToUnit(uint32_t hi, uint32_t lo) {
+        uint64_t bits = ((static_cast<uint64_t>(hi) << 32) | lo) >> 11;
+        return (bits + 1) * (1.0 / 9007199254740992.0);
+    }
+};
+
+// Monte Carlo Execution Cost
+struct MonteCarloResults {
+    size_t paths = 0;
+    double meanCost = 0.0;
+    double stdDevCost = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double expectedShortfall95 = 0.0; // Mean cost of the worst 5% of paths
+};
+
+// Simulates arithmetic price paths under the Almgren-Chriss schedule for params, with permanent impact gamma per unit
+// traded and temporary impact eta per unit of trading rate; cost is the implementation shortfall against the
+// arrival price plus fees. params.volatility is the absolute price volatility per second.
+class MonteCarloCostSimulator {
+public:
+    MonteCarloCostSimulator(const AlmgrenChrissParams& params, Side side, double arrivalPrice, double fees)
+        : params_(params), side_(side), arrivalPrice_(arrivalPrice), fees_(fees),
+        trades_(AlmgrenChrissModel(params).Schedule().trades) {
+    }
+
+    // Paths are split into one chunk per thread on the work-stealing pool; results are reproducible for a given
+    // seed and thread count
+    MonteCarloResults Run(size_t paths, uint64_t seed, size_t threads = 0) const {
+        if (paths == 0) throw std::invalid_argument("Paths must be positive");
+        if (threads == 0) threads = WorkStealingPool::Default().Size() + 1;
+        threads = std::min(threads, paths);
+
+        // Per-thread accumulators on their own cache lines; costs are written to disjoint ranges
+        struct alignas(64) Accumulator {
+            double sum = 0.0;
+            double sumSq = 0.0;
+        };
+        std::vector<Accumulator> accumulators(threads);
+        std::vector<double> costs(paths);
+
+        ParallelFor(threads, [&](size_t t) {
+            size_t begin = paths * t / threads;
+            size_t end = paths * (t + 1) / threads;
+            Accumulator local;
+            for (size_t path = begin; path < end; ++path) {
+                double cost = SimulatePath(path, seed);
+                costs[path] = cost;
+                local.sum += cost;
+                local.sumSq += cost * cost;
+            }
+            accumulators[t] = local;
+        }, threads);
+
+        double sum = 0;
+        double sumSq = 0;
+        for (const auto& accumulator : accumulators) {
+            sum += accumulator.sum;
+            sumSq += accumulator.sumSq;
+        }
+
+        MonteCarloResults results;
+        results.paths = paths;
+        results.meanCost = sum / paths;
+        results.stdDevCost = std::sqrt(std::max(0.0, sumSq / paths - results.meanCost * results.meanCost));
+
+        std::sort(costs.begin(), costs.end());
+        auto quantile = [&](double q) { return costs[std::min(paths - 1, static_cast<size_t>(q * paths))]; };
+        results.p50 = quantile(0.50);
+        results.p95 = quantile(0.95);
+        results.p99 = quantile(0.99);
+
+        size_t tailStart = std::min(paths - 1, static_cast<size_t>(0.95 * paths));
+        results.expectedShortfall95 = std::accumulate(costs.begin() + tailStart, costs.end(), 0.0) / (paths - tailStart);
+        return results;
+    }
+
+private:
+    double SimulatePath(size_t path, uint64_t seed) const {
+        double direction = side_ == Side::Buy ? 1.0 : -1.0; // Adverse price direction
+        double tau = params_.timeHorizon / params_.slices;
+        double diffusion = params_.volatility * std::sqrt(tau);
+
+        double price = arrivalPrice_;
+        double shortfall = 0.0;
+        std::pair<double, double> normals;
+        for (size_t j = 0; j < trades_.size(); ++j) {
+            if (j % 2 == 0) {
+                Philox4x32::Block counter = { static_cast<uint32_t>(j / 2), static_cast<uint32_t>(path),
+                    static_cast<uint32_t>(static_cast<uint64_t>(path) >> 32), 0 };
+                normals = Philox4x32::Normals(Philox4x32::Generate(counter, seed));
+            }
+            double z = j % 2 == 0 ? normals.first : normals.second;
+
+            double n = trades_[j];
+            double executionPrice = price + direction * params_.eta * n / tau;
+            shortfall += direction * n * (executionPrice - arrivalPrice_);
+            price += diffusion * z + direction * params_.gamma * n;
+        }
+        return shortfall + fees_;
+    }
+
+    AlmgrenChrissParams params_;
+    Side side_;
+    double arrivalPrice_;
+    double fees_;
+    std::vector<double> trades_;
+};
+
+// Online Impact Calibration
+// Recursive least squares fit of impact(q) = eta * q + gamma * q^2 with exponential forgetting, O(1) per observation.
+// Quantities are scaled by CONFIG_DEFAULT_QUANTITY internally to keep the normal equations well conditioned.
+class ImpactCalibrator {
+public:
+    // impact is the mid drift, in the direction of the trade, that followed an execution of orderQty
+    void Observe(double orderQty, double impact) {
+        if (orderQty <= 0 || !std::isfinite(impact)) {
+            return;
+        }
+
+        double x0 = orderQty / Scale;
+        double x1 = x0 * x0;
+
+        // Gain k = P x / (lambda + x' P x)
+        double px0 = p_[0][0] * x0 + p_[0][1] * x1;
+        double px1 = p_[1][0] * x0 + p_[1][1] * x1;
+        double denom = CONFIG_CALIBRATION_FORGETTING + x0 * px0 + x1 * px1;
+        double k0 = px0 / denom;
+        double k1 = px1 / denom;
+
+        double error = impact - (theta_[0] * x0 + theta_[1] * x1);
+        theta_[0] += k0 * error;
+        theta_[1] += k1 * error;
+
+        // P = (P - k x' P) / lambda, with x' P = (P x)' since P is symmetric
+        double p00 = (p_[0][0] - k0 * px0) / CONFIG_CALIBRATION_FORGETTING;
+        double p01 = (p_[0][1] - k0 * px1) / CONFIG_CALIBRATION_FORGETTING;
+        double p11 = (p_[1][1] - k1 * px1) / CONFIG_CALIBRATION_FORGETTING;
+        p_[0][0] = p00;
+        p_[0][1] = p01;
+        p_[1][0] = p01;
+        p_[1][1] = p11;
+
+        ++samples_;
+    }
+
+    bool IsCalibrated() const { return samples_ >= CONFIG_CALIBRATION_MIN_SAMPLES; }
+
+    // Calibrated coefficients once enough samples were seen, configured defaults before that. Impact cannot favour
+    // the trader, so a fit that goes negative on noisy drift is clamped to zero.
+    double Eta() const { return IsCalibrated() ? std::max(0.0, theta_[0] / Scale) : CONFIG_IMPACT_ETA; }
+    double Gamma() const { return IsCalibrated() ? std::max(0.0, theta_[1] / (Scale * Scale)) : CONFIG_IMPACT_GAMMA; }
+
+    size_t Samples() const { return samples_; }
+
+private:
+    static constexpr double Scale = CONFIG_DEFAULT_QUANTITY;
+
+    double theta_[2] = { CONFIG_IMPACT_ETA * Scale, CONFIG_IMPACT_GAMMA * Scale * Scale };
+    double p_[2][2] = { { 1e3, 0.0 }, { 0.0, 1e3 } };
+    size_t samples_ = 0;
+};
+
+// Streaming Volatility Estimation
+// O(1) per book over mid log returns: an EWMA of squared tick returns and a two-scale realized variance
+// that compares tick returns with CONFIG_VOLATILITY_SLOW_SCALE-tick returns to cancel microstructure noise.
+// Variances are per second of book time; Volatility() scales them to the execution horizon.
+class VolatilityEstimator {
+public:
+    void Update(double mid, std::chrono::system_clock::time_point timestamp) {
+        if (mid <= 0) {
+            return;
+        }
+
+        double logMid = std::log(mid);
+        double seconds = std::chrono::duration<double>(timestamp.time_since_epoch()).count();
+
+        if (count_ > 0) {
+            const Sample& previous = samples_[(head_ + Window - 1) % Window];
+            double r = logMid - previous.logMid;
+            Blend(fastReturnSq_, r * r);
+            Blend(fastSeconds_, seconds - previous.seconds);
+        }
+        if (count_ >= Window) {
+            // The slot about to be overwritten is one slow-scale interval back
+            const Sample& oldest = samples_[head_];
+            double r = logMid - oldest.logMid;
+            Blend(slowReturnSq_, r * r);
+            Blend(slowSeconds_, seconds - oldest.seconds);
+            ++slowSamples_;
+        }
+
+        samples_[head_] = { logMid, seconds };
+        head_ = (head_ + 1) % Window;
+        ++count_;
+    }
+
+    bool IsReady() const { return slowSamples_ >= CONFIG_VOLATILITY_MIN_SAMPLES; }
+
+    // Per-second variance from tick returns alone
+    double EwmaVariance() const {
+        return fastSeconds_ > 0 ? fastReturnSq_ / fastSeconds_ : 0.0;
+    }
+
+    // Per-second variance with the noise term removed: E[r_k^2] = sigma^2 dt_k + 2 noise^2
+    double RealizedVariance() const {
+        double dt = slowSeconds_ - fastSeconds_;
+        if (dt > 0) {
+            double variance = (slowReturnSq_ - fastReturnSq_) / dt;
+            if (variance > 0) {
+                return variance;
+            }
+        }
+        return slowSeconds_ > 0 ? slowReturnSq_ / slowSeconds_ : EwmaVariance();
+    }
+
+    // Volatility over the execution horizon, or the configured default until warmed up
+    double Volatility() const {
+        if (!IsReady()) {
+            return CONFIG_DEFAULT_VOLATILITY;
+        }
+        return std::sqrt(RealizedVariance() * CONFIG_IMPACT_TIME_HORIZON);
+    }
+
+private:
+    static constexpr size_t Window = CONFIG_VOLATILITY_SLOW_SCALE; // Ring of the last slow-scale books
+
+    struct Sample {
+        double logMid = 0.0;
+        double seconds = 0.0;
+    };
+
+    static void Blend(double& average, double value) {
+        average += CONFIG_VOLATILITY_EWMA_ALPHA * (value - average);
+    }
+
+    std::array<Sample, Window> samples_{};
+    size_t head_ = 0;
+    size_t count_ = 0;
+    size_t slowSamples_ = 0;
+
+    double fastReturnSq_ = 0.0;
+    double fastSeconds_ = 0.0;
+    double slowReturnSq_ = 0.0;
+    double slowSeconds_ = 0.0;
+};
+
+// Online Maker/Taker Model
+// Logistic regression for the probability that an order executes as taker, trained by SGD on the book stream.
+// Training label: a passive order of size q resting at the touch counts as filled (maker) when by the next book
+// its level was cleared or shrank by at least q; otherwise it would have had to cross the spread (taker).
+class MakerTakerModel {
+public:
+    // Bias, spread (bps), imbalance, log depth, volatility, size / touch depth; padded to a full AVX-512 vector
+    static constexpr size_t FeatureCount = 8;
+    enum Feature { Bias, SpreadBps, Imbalance, LogDepth, Volatility, SizeRatio };
+    using Features = std::array<double, FeatureCount>;
+
+    // Book-level features for a passive order on side (size feature left at 0); touchDepth receives the scale for sizes
+    template <Side S>
+    static Features ExtractBookFeatures(const OrderBook& book, double volatility, double& touchDepth) {
+        // The side a passive order rests on is the one a market order on the same side does not consume
+        const auto& own = SideTraits<S>::Resting(book);
+        const auto& opposite = SideTraits<S>::Levels(book);
+
+        double ownDepth = SimdKernels::LevelDepth(own.data(), std::min<size_t>(own.size(), CONFIG_MAKER_TAKER_DEPTH_LEVELS));
+        double oppositeDepth = SimdKernels::LevelDepth(opposite.data(), std::min<size_t>(opposite.size(), CONFIG_MAKER_TAKER_DEPTH_LEVELS));
+
+        double mid = (book.bids[0].first + book.asks[0].first) / 2;
+        double depth = ownDepth + oppositeDepth;
+        touchDepth = depth > 0 ? depth / 2 : 1.0;
+
+        Features features{};
+        features[Bias] = 1.0;
+        features[SpreadBps] = (book.asks[0].first - book.bids[0].first) / mid * 1e4;
+        features[Imbalance] = depth > 0 ? (ownDepth - oppositeDepth) / depth : 0.0;
+        features[LogDepth] = std::log1p(depth);
+        features[Volatility] = volatility;
+        return features;
+    }
+
+    double Predict(const Features& features) const {
+        return 1 / (1 + std::exp(-Logit(features)));
+    }
+
+    // Taker probability for many sizes sharing the book features; only the size and volatility terms vary
+    void PredictBatch(Features base, const double* orderQtys, const double* volatilities, size_t count,
+        double touchDepth, double* out) const {
+        base[Volatility] = 0.0;
+        base[SizeRatio] = 0.0;
+        double shared = Logit(base);
+        double sizeWeight = weights_[SizeRatio] / touchDepth;
+        double volatilityWeight = weights_[Volatility];
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = shared + sizeWeight * orderQtys[i] + volatilityWeight * volatilities[i];
+        }
+        SimdKernels::Sigmoid(out, count, out);
+    }
+
+    // One SGD step on the log loss with L2 regularisation; label 1 = taker
+    void Train(const Features& features, double label) {
+        double error = label - Predict(features);
+        for (size_t i = 0; i < FeatureCount; ++i) {
+            weights_[i] += CONFIG_MAKER_TAKER_LEARNING_RATE * (error * features[i] - CONFIG_MAKER_TAKER_L2 * weights_[i]);
+        }
+        ++samples_;
+    }
+
+    // Advance the passive probes against this book, train on the ones that resolved, then queue probes for it.
+    // A probe joins the back of the touch queue. Size that leaves its price level depletes the queue ahead of it
+    // first and only then fills it; size added later queues behind it. It is labelled maker once filled or once
+    // the price trades through it, and taker if it is still unfilled after CONFIG_MAKER_TAKER_HORIZON_BOOKS books.
+    void OnBook(const OrderBook& book, double volatility) {
+        if (book.bids.empty() || book.asks.empty()) {
+            return;
+        }
+
+        AdvanceProbes<Side::Buy>(book);
+        AdvanceProbes<Side::Sell>(book);
+
+        QueueProbes<Side::Buy>(book, volatility);
+        QueueProbes<Side::Sell>(book, volatility);
+    }
+
+    bool IsTrained() const { return samples_ >= CONFIG_MAKER_TAKER_MIN_SAMPLES; }
+    const Features& Weights() const { return weights_; }
+
+    // Take over another model's coefficients and sample count; its pending probes stay with it
+    void CopyCoefficients(const MakerTakerModel& other) {
+        weights_ = other.weights_;
+        samples_ = other.samples_;
+    }
+
+private:
+    struct Probe {
+        double price = 0.0; // Touch price the passive order rests at
+        double levelSize = 0.0; // Size at that price on the last book
+        double queueAhead = 0.0; // Size still queued in front of the order
+        double filled = 0.0;
+        double quantity = 0.0;
+        size_t age = 0; // Books seen since the order was placed
+        Features features{};
+    };
+
+    double Logit(const Features& features) const {
+        return SimdKernels::Dot(weights_.data(), features.data(), FeatureCount);
+    }
+
+    template <Side S>
+    void AdvanceProbes(const OrderBook& book) {
+        const auto& levels = SideTraits<S>::Resting(book);
+        auto& pending = pending_[static_cast<int>(S)];
+        size_t kept = 0;
+        for (Probe& probe : pending) {
+            double remaining = 0; // Size left at the probe's price
+            for (const auto& level : levels) {
+                if (level.first == probe.price) {
+                    remaining = level.second;
+                    break;
+                }
+            }
+
+            double depleted = std::max(0.0, probe.levelSize - remaining);
+            double fromQueue = std::min(depleted, probe.queueAhead);
+            probe.queueAhead -= fromQueue;
+            probe.filled += depleted - fromQueue;
+            probe.levelSize = remaining;
+            ++probe.age;
+
+            if (SideTraits<S>::TradedThrough(levels[0].first, probe.price) || probe.filled >= probe.quantity) {
+                Train(probe.features, 0.0);
+            }
+            else if (probe.age >= CONFIG_MAKER_TAKER_HORIZON_BOOKS) {
+                Train(probe.features, 1.0);
+            }
+            else {
+                pending[kept++] = probe;
+            }
+        }
+        pending.resize(kept);
+    }
+
+    template <Side S>
+    void QueueProbes(const OrderBook& book, double volatility) {
+        static const double probeScales[] = { 0.25, 0.5, 1.0, 2.0, 4.0 };
+
+        double touchDepth = 1.0;
+        Features base = ExtractBookFeatures<S>(book, volatility, touchDepth);
+        const auto& touch = SideTraits<S>::Resting(book)[0];
+
+        for (double scale : probeScales) {
+            Probe probe;
+            probe.price = touch.first;
+            probe.levelSize = touch.second;
+            probe.queueAhead = touch.second;
+            probe.quantity = scale * CONFIG_DEFAULT_QUANTITY;
+            probe.features = base;
+            probe.features[SizeRatio] = probe.quantity / touchDepth;
+            pending_[static_cast<int>(S)].push_back(probe);
+        }
+    }
+
+    // Starts from the fixed model's intercept and volatility coefficient; the book and size terms are learned
+    alignas(64) Features weights_ = { CONFIG_MAKER_TAKER_INTERCEPT, 0.0, 0.0, 0.0, CONFIG_MAKER_TAKER_VOL_COEFF, 0.0, 0.0, 0.0 };
+    std::vector<Probe> pending_[2]; // Indexed by Side
+    size_t samples_ = 0;
+};
+
+// Slippage Regression
+// Linear fit of slippage on order size from exponentially weighted running moments, O(1) per observation.
+// Coefficients are guarded by a mutex so the UI and API threads can query estimates while the worker updates them.
+class SlippageRegression {
+public:
+    void Observe(double size, double slippage) {
+        if (!std::isfinite(size) || !std::isfinite(slippage)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Weighted Welford update of means and co-moments
+        weight_ = CONFIG_SLIPPAGE_REGRESSION_DECAY * weight_ + 1;
+        double dx = size - meanX_;
+        meanX_ += dx / weight_;
+        meanY_ += (slippage - meanY_) / weight_;
+        momentXX_ = CONFIG_SLIPPAGE_REGRESSION_DECAY * momentXX_ + dx * (size - meanX_);
+        momentXY_ = CONFIG_SLIPPAGE_REGRESSION_DECAY * momentXY_ + dx * (slippage - meanY_);
+
+        slope_ = momentXX_ > 1e-12 * weight_ * (1 + meanX_ * meanX_) ? momentXY_ / momentXX_ : 0.0;
+        intercept_ = meanY_ - slope_ * meanX_;
+        ++samples_;
+    }
+
+    double Estimate(double size) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return intercept_ + slope_ * size;
+    }
+
+    bool IsReady() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return samples_ >= CONFIG_SLIPPAGE_REGRESSION_MIN_SAMPLES;
+    }
+
+    double Slope() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return slope_;
+    }
+
+    double Intercept() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return intercept_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    double weight_ = 0.0;
+    double meanX_ = 0.0;
+    double meanY_ = 0.0;
+    double momentXX_ = 0.0;
+    double momentXY_ = 0.0;
+    double slope_ = 0.0;
+    double intercept_ = 0.0;
+    size_t samples_ = 0;
+};
+
+// Multi-Venue Consolidated Book
+// Latest book per venue for one instrument, merged into a consolidated ladder per side ordered best price first
+// (ties by venue). A venue update re-merges only the part of the ladder at or behind its first changed level.
+// Routing runs a k-way merge of the venue ladders ordered by per-unit cost: price plus the venue's fee tier, which is
+// charged per unit of quantity like every other fee in the simulator (fees = quantity * feeTier). Each venue's
+// truncated tail follows its levels at TailPrice, as in the single-venue walk.
+// Not synchronised: update and query from one thread.
+struct VenueLevel {
+    double price = 0.0;
+    double size = 0.0;
+    size_t venue = 0; // Index into Venues()
+};
+
+struct VenueAllocation {
+    std::string venue;
+    double quantity = 0.0;
+    double notional = 0.0;
+    double fees = 0.0;
+};
+
+struct RoutingPlan {
+    std::vector<VenueAllocation> allocations; // Venues that received a share, in venue order
+    double filledQuantity = 0.0; // Size covered by the venues' levels and tails
+    double unfilledQuantity = 0.0; // Size beyond every venue's depth, priced at the cheapest tail
+    double averagePrice = 0.0; // Over filled and unfilled size
+    double fees = 0.0;
+};
+
+class ConsolidatedBook {
+public:
+    // Returns true when the book changed the consolidated ladder
+    bool Update(const OrderBook& book) {
+        size_t venue = VenueIndex(book.venue);
+        OrderBook& previous = books_[venue];
+
+        size_t askFrom = FirstChangedLevel(previous.asks, book.asks);
+        size_t bidFrom = FirstChangedLevel(previous.bids, book.bids);
+        if (askFrom != OrderBook::Unchanged) {
+            MergeSide<Side::Buy>(asks_, venue, previous.asks, book.asks, askFrom);
+        }
+        if (bidFrom != OrderBook::Unchanged) {
+            MergeSide<Side::Sell>(bids_, venue, previous.bids, book.bids, bidFrom);
+        }
+
+        previous = book;
+        bool changed = askFrom != OrderBook::Unchanged || bidFrom != OrderBook::Unchanged;
+        if (changed) {
+            ++version_;
+        }
+        return changed;
+    }
+
+    // Fee tier of a venue, charged per unit of quantity as in SimulationResults::fees (quantity * feeTier)
+    void SetVenueFee(const std::string& venue, double feeTier) {
+        if (feeTier < 0 || feeTier > 1) throw std::invalid_argument("Fee tier must be between 0 and 1");
+        fees_[VenueIndex(venue)] = feeTier;
+    }
+
+    const std::vector<std::string>& Venues() const { return venues_; }
+    uint64_t Version() const { return version_; }
+
+    // Consolidated ladder of the side a market order on S consumes
+    template <Side S>
+    const std::vector<VenueLevel>& Levels() const {
+        if constexpr (S == Side::Buy) return asks_;
+        else return bids_;
+    }
+
+    // Consolidated ladder with the venues aggregated per price level
+    OrderBook Snapshot() const {
+        OrderBook book;
+        book.venue = "consolidated";
+        book.sequence = version_;
+        AggregateSide(asks_, book.asks);
+        AggregateSide(bids_, book.bids);
+        for (const OrderBook& venueBook : books_) {
+            book.symbol = venueBook.symbol;
+            book.timestamp = std::max(book.timestamp, venueBook.timestamp);
+            book.askTailSize += venueBook.askTailSize;
+            book.bidTailSize += venueBook.bidTailSize;
+        }
+        return book;
+    }
+
+    // Split a market order across venues at the lowest total cost: levels are taken cheapest first by price plus
+    // venue fee, which is optimal because every level's cost is linear in the size taken from it
+    template <Side S>
+    RoutingPlan Route(double quantity) const {
+        struct Cursor {
+            double cost;
+            size_t venue;
+            size_t level; // levels.size() for the tail
+        };
+        auto worse = [](const Cursor& a, const Cursor& b) {
+            return a.cost > b.cost || (a.cost == b.cost && a.venue > b.venue);
+        };
+
+        // Next level (or tail) of a venue, skipped when it has no size
+        std::vector<Cursor> heap;
+        auto push = [&](size_t venue, size_t level) {
+            const OrderBook& book = books_[venue];
+            const auto& levels = SideTraits<S>::Levels(book);
+            if (level < levels.size()) {
+                heap.push_back({ UnitCost<S>(levels[level].first, fees_[venue]), venue, level });
+            }
+            else if (level == levels.size() && !levels.empty() && SideTraits<S>::TailSize(book) > 0) {
+                heap.push_back({ UnitCost<S>(TailPrice<S>(levels), fees_[venue]), venue, level });
+            }
+            else {
+                return;
+            }
+            std::push_heap(heap.begin(), heap.end(), worse);
+        };
+        for (size_t v = 0; v < books_.size(); ++v) {
+            push(v, 0);
+        }
+
+        std::vector<VenueAllocation> allocations(venues_.size());
+        auto fill = [&](size_t venue, double size, double price) {
+            allocations[venue].quantity += size;
+            allocations[venue].notional += size * price;
+        };
+
+        double remaining = quantity;
+        while (remaining > 0 && !heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), worse);
+            Cursor cursor = heap.back();
+            heap.pop_back();
+
+            const OrderBook& book = books_[cursor.venue];
+            const auto& levels = SideTraits<S>::Levels(book);
+            bool tail = cursor.level == levels.size();
+            double size = tail ? SideTraits<S>::TailSize(book) : levels[cursor.level].second;
+            double take = std::min(remaining, size);
+            fill(cursor.venue, take, tail ? TailPrice<S>(levels) : levels[cursor.level].first);
+            remaining -= take;
+
+            push(cursor.venue, cursor.level + 1);
+        }
+
+        // Size past every venue's depth goes to the cheapest tail, priced there but flagged as unfilled
+        RoutingPlan plan;
+        if (remaining > 0) {
+            size_t best = books_.size();
+            double bestCost = 0.0;
+            for (size_t v = 0; v < books_.size(); ++v) {
+                const auto& levels = SideTraits<S>::Levels(books_[v]);
+                if (levels.empty()) {
+                    continue;
+                }
+                double cost = UnitCost<S>(TailPrice<S>(levels), fees_[v]);
+                if (best == books_.size() || cost < bestCost) {
+                    best = v;
+                    bestCost = cost;
+                }
+            }
+            if (best < books_.size()) {
+                fill(best, remaining, TailPrice<S>(SideTraits<S>::Levels(books_[best])));
+                plan.unfilledQuantity = remaining;
+            }
+        }
+
+        double notional = 0.0;
+        for (size_t v = 0; v < allocations.size(); ++v) {
+            VenueAllocation& allocation = allocations[v];
+            if (allocation.quantity <= 0) {
+                continue;
+            }
+            allocation.venue = venues_[v];
+            allocation.fees = allocation.quantity * fees_[v];
+            plan.filledQuantity += allocation.quantity;
+            plan.fees += allocation.fees;
+            notional += allocation.notional;
+            plan.allocations.push_back(allocation);
+        }
+        if (plan.filledQuantity > 0) {
+            plan.averagePrice = notional / plan.filledQuantity;
+        }
+        plan.filledQuantity -= plan.unfilledQuantity;
+        return plan;
+    }
+
+private:
+    // Per-unit cost of a level: price plus fee paid on a buy, price minus fee received on a sell (negated, so
+    // lower is better for both)
+    template <Side S>
+    static double UnitCost(double price, double feeTier) {
+        return SideTraits<S>::Sign * price + feeTier;
+    }
+
+    size_t VenueIndex(const std::string& venue) {
+        auto it = venueIndex_.find(venue);
+        if (it != venueIndex_.end()) {
+            return it->second;
+        }
+        venueIndex_.emplace(venue, venues_.size());
+        venues_.push_back(venue);
+        books_.emplace_back();
+        fees_.push_back(CONFIG_DEFAULT_FEE_TIER);
+        return venues_.size() - 1;
+    }
+
+    // True when price a is better than b for the side a market order on S consumes
+    template <Side S>
+    static bool Better(double a, double b) { return SideTraits<S>::Sign * a < SideTraits<S>::Sign * b; }
+
+    // Venue levels before `from` are unchanged and strictly better than any changed level, so the ladder is kept
+    // up to the first changed price and only the tail is re-merged with the venue's new levels
+    template <Side S>
+    void MergeSide(std::vector<VenueLevel>& ladder, size_t venue, const std::vector<std::pair<double, double>>& previous,
+        const std::vector<std::pair<double, double>>& levels, size_t from) {
+        double boundary;
+        if (from < previous.size() && from < levels.size()) {
+            boundary = Better<S>(previous[from].first, levels[from].first) ? previous[from].first : levels[from].first;
+        }
+        else {
+            boundary = from < previous.size() ? previous[from].first : levels[from].first;
+        }
+
+        auto cut = std::partition_point(ladder.begin(), ladder.end(),
+            [&](const VenueLevel& level) { return Better<S>(level.price, boundary); });
+
+        scratch_.clear();
+        auto it = cut;
+        size_t next = from;
+        while (true) {
+            while (it != ladder.end() && it->venue == venue) {
+                ++it;
+            }
+            bool haveOld = it != ladder.end();
+            bool haveNew = next < levels.size();
+            if (!haveOld && !haveNew) {
+                break;
+            }
+            if (haveNew && (!haveOld || Better<S>(levels[next].first, it->price)
+                || (levels[next].first == it->price && venue < it->venue))) {
+                scratch_.push_back({ levels[next].first, levels[next].second, venue });
+                ++next;
+            }
+            else {
+                scratch_.push_back(*it);
+                ++it;
+            }
+        }
+
+        ladder.erase(cut, ladder.end());
+        ladder.insert(ladder.end(), scratch_.begin(), scratch_.end());
+    }
+
+    static void AggregateSide(const std::vector<VenueLevel>& ladder, std::vector<std::pair<double, double>>& out) {
+        for (const VenueLevel& level : ladder) {
+            if (!out.empty() && out.back().first == level.price) {
+                out.back().second += level.size;
+            }
+            else {
+                out.emplace_back(level.price, level.size);
+            }
+        }
+    }
+
+    std::vector<std::string> venues_;
+    std::unordered_map<std::string, size_t> venueIndex_;
+    std::vector<OrderBook> books_; // Latest book per venue
+    std::vector<double> fees_;
+    std::vector<VenueLevel> asks_;
+    std::vector<VenueLevel> bids_;
+    std::vector<VenueLevel> scratch_;
+    uint64_t version_ = 0;
+};
+
+// Parameter Grid Results
+// Cells are laid out [book][quantity][volatility][fee tier], books ordered oldest to newest
+struct GridResults {
+    std::vector<double> quantities;
+    std::vector<double> volatilities;
+    std::vector<double> feeTiers;
+    size_t books = 0;
+    std::vector<SimulationResults> cells;
+
+    const SimulationResults& At(size_t book, size_t quantity, size_t volatility, size_t feeTier) const {
+        return cells[((book * quantities.size() + quantity) * volatilities.size() + volatility) * feeTiers.size() + feeTier];
+    }
+};
+
+// Execution Schedules
+enum class ScheduleType { TWAP, VWAP, POV };
+
+// Parent order sliced into child market orders over a window of recorded book time
+struct ExecutionSchedule {
+    ScheduleType type = ScheduleType::TWAP;
+    Side side = Side::Buy;
+    double quantity = CONFIG_DEFAULT_QUANTITY;
+    double feeTier = CONFIG_DEFAULT_FEE_TIER;
+    std::chrono::system_clock::time_point start{}; // Default: the oldest book in the history
+    double duration = CONFIG_SCHEDULE_DURATION; // Seconds of book time
+    size_t slices = CONFIG_EXECUTION_SLICES; // TWAP and VWAP child orders
+    double participationRate = CONFIG_POV_PARTICIPATION; // POV share of the estimated market volume
+};
+
+struct ChildFill {
+    std::chrono::system_clock::time_point timestamp;
+    uint64_t sequence = 0; // Book the child executed against
+    double quantity = 0.0;
+    double averagePrice = 0.0;
+    double marketImpact = 0.0;
+};
+
+struct ScheduleResults {
+    std::vector<ChildFill> fills;
+    double arrivalPrice = 0.0; // Mid of the first book in the window
+    double filledQuantity = 0.0;
+    double averagePrice = 0.0;
+    double slippage = 0.0; // Per-unit shortfall of the average price against arrival
+    double fees = 0.0;
+    double marketImpact = 0.0;
+    double netCost = 0.0;
+    double latency = 0.0;
+};
+
+// Market volume an aggressor on side S took between two books, estimated from liquidity removed at or through the
+// previous touch of the side it consumes: levels the new touch has moved past were consumed, and a shrinking touch
+// level lost the difference
+template <Side S>
+double EstimateTradedVolume(const OrderBook& previous, const OrderBook& current) {
+    const auto& touch = SideTraits<S>::Levels(current);
+    if (touch.empty()) {
+        return 0.0;
+    }
+    double volume = 0.0;
+    for (const auto& level : SideTraits<S>::Levels(previous)) {
+        if (SideTraits<S>::Sign * (level.first - touch[0].first) < 0) volume += level.second;
+        else if (level.first == touch[0].first) volume += std::max(0.0, level.second - touch[0].second);
+        else break;
+    }
+    return volume;
+}
+
+// Market volume between two books, both sides
+double EstimateTradedVolume(const OrderBook& previous, const OrderBook& current) {
+    return EstimateTradedVolume<Side::Buy>(previous, current) + EstimateTradedVolume<Side::Sell>(previous, current);
+}
+
+// Standing simulation request, re-simulated only when a book update can change its result.
+// Reset valid after changing the order parameters.
+struct StandingSimulation {
+    Side side = Side::Buy;
+    double quantity = CONFIG_DEFAULT_QUANTITY;
+    double volatility = CONFIG_DEFAULT_VOLATILITY;
+    double feeTier = CONFIG_DEFAULT_FEE_TIER;
+    bool liveVolatility = true; // Use the streaming estimate instead of volatility
+
+    SimulationResults results;
+    bool valid = false;
+    uint64_t sequence = 0; // Book sequence the results were computed on
+    size_t levelsTouched = 0; // Levels of the consumed side the fill reached
+    double referencePrice = 0.0;
+};
+
+// Simulation Policies
+// BasicTradeSimulator is assembled from three compile-time policies, so a model combination is fully inlined with
+// no virtual dispatch. A policy only needs the members used below:
+//   Slippage: ReferencePrice<S>(book), Slippage<S>(qty, book, levelsTouched), SlippageCurve<S>(qtys, book, reference),
+//             static constexpr Reference
+//   Impact:   Impact(qty, volatility), ImpactBatch(qtys, volatilities, count, out), Observe(qty, impact), Eta(), Gamma()
+//   Fill:     TakerProbability<S>(qty, volatility, book), TakerProbabilityBatch<S>(book, qtys, volatilities, count, out),
+//             OnBook(book, volatility)
+
+// Market order walked through the consumed side of the book, measured against mid, touch or an arrival price
+template <SlippageReference R = SlippageReference::Mid>
+class BookWalkSlippage {
+public:
+    static constexpr SlippageReference Reference = R;
+
+    void SetArrivalPrice(double arrivalPrice) requires (R == SlippageReference::Arrival) {
+        if (arrivalPrice <= 0) {
+            throw std::invalid_argument("Arrival price must be positive");
+        }
+        arrivalPrice_ = arrivalPrice;
+    }
+
+    template <Side S>
+    double ReferencePrice(const OrderBook& book) const {
+        if constexpr (R == SlippageReference::Touch) {
+            return SideTraits<S>::Levels(book)[0].first;
+        }
+        else if constexpr (R == SlippageReference::Arrival) {
+            return arrivalPrice_;
+        }
+        else {
+            return (book.bids[0].first + book.asks[0].first) / 2;
+        }
+    }
+
+    // levelsTouched (optional) receives how many levels the fill reached, plus one if it ran out of book
+    template <Side S>
+    double Slippage(double orderQty, const OrderBook& book, size_t* levelsTouched = nullptr) const {
+        const auto& levels = SideTraits<S>::Levels(book);
+        double filled = 0;
+        double referencePrice = ReferencePrice<S>(book);
+
+        // Find the levels the order consumes completely
+        size_t fullLevels = 0;
+        while (fullLevels < levels.size() && filled + levels[fullLevels].second <= orderQty) {
+            filled += levels[fullLevels].second;
+            ++fullLevels;
+        }
+
+        // Notional of the full levels (SIMD) plus the partially filled level, or the tail once the levels run out
+        double cost = SimdKernels::LevelNotional(levels.data(), fullLevels);
+        if (fullLevels < levels.size() && filled < orderQty) {
+            cost += (orderQty - filled) * levels[fullLevels].first;
+        }
+        else if (filled < orderQty && !levels.empty()) {
+            cost += (orderQty - filled) * TailPrice<S>(levels);
+        }
+
+        if (levelsTouched) {
+            *levelsTouched = fullLevels + (filled < orderQty ? 1 : 0);
+        }
+
+        return SideTraits<S>::Sign * ((cost / orderQty) - referencePrice);
+    }
+
+    // Same fill model as Slippage, resuming the walk from the previous size
+    template <Side S>
+    std::vector<double> SlippageCurve(const std::vector<double>& orderQtys, const OrderBook& book,
+        double referencePrice) const {
+        const auto& levels = SideTraits<S>::Levels(book);
+        std::vector<double> slippages(orderQtys.size());
+        double filled = 0;
+        double cost = 0;
+        size_t level = 0;
+        double levelFilled = 0; // Size already taken from levels[level]
+
+        for (size_t i = 0; i < orderQtys.size(); ++i) {
+            double orderQty = orderQtys[i];
+
+            while (filled < orderQty && level < levels.size()) {
+                double price = levels[level].first;
+                double size = levels[level].second;
+                double take = std::min(orderQty - filled, size - levelFilled);
+
+                cost += take * price;
+                filled += take;
+                levelFilled += take;
+
+                if (levelFilled >= size) {
+                    ++level;
+                    levelFilled = 0;
+                }
+            }
+
+            // Size past the visible levels comes from the tail
+            double tailCost = filled < orderQty && !levels.empty() ? (orderQty - filled) * TailPrice<S>(levels) : 0.0;
+            slippages[i] = SideTraits<S>::Sign * (((cost + tailCost) / orderQty) - referencePrice);
+        }
+
+        return slippages;
+    }
+
+private:
+    double arrivalPrice_ = 0.0; // Only used with SlippageReference::Arrival
+};
+
+// Almgren-Chriss style impact with the configured constant coefficients
+class StaticImpact {
+public:
+    double Impact(double orderQty, double volatility) const {
+        return Evaluate(Eta(), Gamma(), orderQty, volatility);
+    }
+
+    void ImpactBatch(const double* orderQtys, const double* volatilities, size_t count, double* out) const {
+        SimdKernels::MarketImpact(orderQtys, volatilities, count, Eta(), Gamma(), CONFIG_IMPACT_TIME_HORIZON, out);
+    }
+
+    void Observe(double, double) {}
+
+    double Eta() const { return CONFIG_IMPACT_ETA; }
+    double Gamma() const { return CONFIG_IMPACT_GAMMA; }
+
+    static double Evaluate(double eta, double gamma, double orderQty, double volatility) {
+        // Simplified Almgren-Chriss model
+        double timeHorizon = CONFIG_IMPACT_TIME_HORIZON; // Execution time in seconds
+
+        return eta * orderQty + gamma * orderQty * orderQty + volatility * sqrt(orderQty) / sqrt(timeHorizon);
+    }
+};
+
+// Almgren-Chriss style impact with eta and gamma calibrated online from books and observed trades
+class CalibratedImpact {
+public:
+    double Impact(double orderQty, double volatility) const {
+        return StaticImpact::Evaluate(calibrator_.Eta(), calibrator_.Gamma(), orderQty, volatility);
+    }
+
+    void ImpactBatch(const double* orderQtys, const double* volatilities, size_t count, double* out) const {
+        SimdKernels::MarketImpact(orderQtys, volatilities, count,
+            calibrator_.Eta(), calibrator_.Gamma(), CONFIG_IMPACT_TIME_HORIZON, out);
+    }
+
+    void Observe(double orderQty, double impact) { calibrator_.Observe(orderQty, impact); }
+
+    double Eta() const { return calibrator_.Eta(); }
+    double Gamma() const { return calibrator_.Gamma(); }
+    const ImpactCalibrator& Calibrator() const { return calibrator_; }
+
+private:
+    ImpactCalibrator calibrator_;
+};
+
+// Fixed-coefficient logistic regression for the taker probability
+class StaticMakerTaker {
+public:
+    template <Side S>
+    double TakerProbability(double orderQty, double volatility, const OrderBook&) const {
+        // Simplified logistic regression model
+        return 1 / (1 + exp(-(CONFIG_MAKER_TAKER_QTY_COEFF * orderQty + CONFIG_MAKER_TAKER_VOL_COEFF * volatility
+            + CONFIG_MAKER_TAKER_INTERCEPT)));
+    }
+
+    template <Side S>
+    void TakerProbabilityBatch(const OrderBook&, const double* orderQtys, const double* volatilities,
+        size_t count, double* out) const {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = CONFIG_MAKER_TAKER_QTY_COEFF * orderQtys[i] + CONFIG_MAKER_TAKER_VOL_COEFF * volatilities[i]
+                + CONFIG_MAKER_TAKER_INTERCEPT;
+        }
+        SimdKernels::Sigmoid(out, count, out);
+    }
+
+    void OnBook(const OrderBook&, double) {}
+    void Publish() {}
+};
+
+// Online logistic maker/taker model, falling back to the fixed coefficients until trained. OnBook trains a private
+// copy (probes and SGD); simulations price with the coefficients last handed over by Publish, so training can run
+// without the simulator's model lock.
+class OnlineMakerTaker {
+public:
+    template <Side S>
+    double TakerProbability(double orderQty, double volatility, const OrderBook& book) const {
+        if (!model_.IsTrained()) {
+            return fallback_.TakerProbability<S>(orderQty, volatility, book);
+        }
+
+        double touchDepth = 1.0;
+        auto features = MakerTakerModel::ExtractBookFeatures<S>(book, volatility, touchDepth);
+        features[MakerTakerModel::SizeRatio] = orderQty / touchDepth;
+        return model_.Predict(features);
+    }
+
+    template <Side S>
+    void TakerProbabilityBatch(const OrderBook& book, const double* orderQtys, const double* volatilities,
+        size_t count, double* out) const {
+        if (!model_.IsTrained()) {
+            fallback_.TakerProbabilityBatch<S>(book, orderQtys, volatilities, count, out);
+            return;
+        }
+
+        double touchDepth = 1.0;
+        auto features = MakerTakerModel::ExtractBookFeatures<S>(book, 0.0, touchDepth);
+        model_.PredictBatch(features, orderQtys, volatilities, count, touchDepth, out);
+    }
+
+    void OnBook(const OrderBook& book, double volatility) { trainer_.OnBook(book, volatility); }
+    void Publish() { model_.CopyCoefficients(trainer_); }
+
+    // Published model used for pricing
+    const MakerTakerModel& Model() const { return model_; }
+
+private:
+    MakerTakerModel model_;
+    MakerTakerModel trainer_;
+    StaticMakerTaker fallback_;
+};
+
+// Trade Simulator
+template <typename SlippagePolicy, typename ImpactPolicy, typename FillPolicy>
+class BasicTradeSimulator {
+public:
+    // Simulations read books from the store; OnBook-driven model updates do not need it. Single-venue
+    // simulations and the online models only use books from venue; every venue feeds the consolidated book.
+    explicit BasicTradeSimulator(BookStore& books, std::string venue = CONFIG_EXCHANGE)
+        : books_(books), venue_(std::move(venue)) {}
+
+    const std::string& Venue() const { return venue_; }
+
+    // Overloads taking a volatility use it as given; the streaming estimate only applies through the overload
+    // without one, standing requests with liveVolatility, and the Monte Carlo and schedule paths
+    SimulationResults SimulateTrade(double quantity, double volatility, double feeTier) {
+        return SimulateTrade(Side::Buy, quantity, volatility, feeTier);
+    }
+
+    // Evaluated with the streaming volatility estimate (the configured default while it warms up)
+    SimulationResults SimulateTrade(Side side, double quantity, double feeTier) {
+        SimulationResults results = SimulateTrade(side, quantity, CurrentVolatility(), feeTier);
+        results.volatilitySource = CurrentVolatilitySource();
+        return results;
+    }
+
+    SimulationResults SimulateTrade(Side side, double quantity, double volatility, double feeTier) {
+        return side == Side::Buy
+            ? SimulateTrade<Side::Buy>(quantity, volatility, feeTier)
+            : SimulateTrade<Side::Sell>(quantity, volatility, feeTier);
+    }
+
+    template <Side S>
+    SimulationResults SimulateTrade(double quantity, double volatility, double feeTier) {
+        try {
+            ValidateInputs(quantity, volatility, feeTier);
+
+            SimulationResults results;
+            OrderBook currentBook;
+
+            {
+                std::lock_guard<std::mutex> lock(books_.mutex);
+                if (const OrderBook* latest = LatestBook()) {
+                    currentBook = *latest;
+                }
+            }
+
+            if (currentBook.bids.empty() || currentBook.asks.empty()) {
+                return results;
+            }
+
+            return SimulateOnBook<S>(currentBook, quantity, volatility, feeTier, nullptr);
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Trade simulation error");
+            return SimulationResults();
+        }
+    }
+
+    // Re-simulate a standing request only if the latest book changed within the levels its fill
+    // reached or moved its reference price. Returns true when request.results were updated.
+    bool Refresh(StandingSimulation& request) {
+        return request.side == Side::Buy ? Refresh<Side::Buy>(request) : Refresh<Side::Sell>(request);
+    }
+
+    template <Side S>
+    bool Refresh(StandingSimulation& request) {
+        try {
+            double volatility = request.liveVolatility ? CurrentVolatility() : request.volatility;
+            VolatilitySource source = request.liveVolatility ? CurrentVolatilitySource() : VolatilitySource::Input;
+            ValidateInputs(request.quantity, volatility, request.feeTier);
+
+            OrderBook currentBook;
+            bool fillUnchanged = false;
+
+            // Decide under the store's mutex whether the fill can have moved and copy the book; the models run
+            // after it is released so ingest never waits on them
+            {
+                std::lock_guard<std::mutex> lock(books_.mutex);
+                const OrderBook* latestBook = LatestBook();
+                if (!latestBook) {
+                    return false;
+                }
+
+                const OrderBook& latest = *latestBook;
+                if (latest.bids.empty() || latest.asks.empty()) {
+                    return false;
+                }
+                if (request.valid && latest.sequence == request.sequence) {
+                    return false;
+                }
+
+                if (request.valid && slippage_.template ReferencePrice<S>(latest) == request.referencePrice) {
+                    // Fold the dirty ranges of every book published since the last simulation
+                    size_t dirtyFrom = OrderBook::Unchanged;
+                    bool covered = false;
+                    for (auto it = books_.history.rbegin(); it != books_.history.rend(); ++it) {
+                        if (it->sequence <= request.sequence) {
+                            covered = it->sequence == request.sequence;
+                            break;
+                        }
+                        if (it->venue != venue_) {
+                            continue;
+                        }
+                        dirtyFrom = std::min(dirtyFrom, SideTraits<S>::DirtyFrom(*it));
+                    }
+
+                    fillUnchanged = covered && dirtyFrom >= request.levelsTouched;
+                }
+
+                currentBook = latest;
+            }
+
+            if (fillUnchanged) {
+                // Only the model terms can have moved
+                request.sequence = currentBook.sequence;
+                SimulationResults updated = request.results;
+                ApplyModels<S>(updated, currentBook, request.quantity, volatility, request.feeTier);
+                updated.volatilitySource = source;
+                bool changed = updated.netCost != request.results.netCost
+                    || updated.makerTakerRatio != request.results.makerTakerRatio
+                    || updated.volatilitySource != request.results.volatilitySource;
+                request.results = updated;
+                return changed;
+            }
+
+            request.results = SimulateOnBook<S>(currentBook, request.quantity, volatility,
+                request.feeTier, &request.levelsTouched);
+            request.results.volatilitySource = source;
+            request.referencePrice = slippage_.template ReferencePrice<S>(currentBook);
+            request.sequence = currentBook.sequence;
+            request.valid = true;
+            return true;
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Standing simulation error");
+            return false;
+        }
+    }
+
+    // Cost curve for ascending order sizes from one copy and one walk of the latest book.
+    // volatilities and feeTiers hold either one value per quantity or a single shared value.
+    std::vector<SimulationResults> SimulateTradeCurve(const std::vector<double>& quantities,
+        const std::vector<double>& volatilities, const std::vector<double>& feeTiers) {
+        return SimulateTradeCurve(Side::Buy, quantities, volatilities, feeTiers);
+    }
+
+    std::vector<SimulationResults> SimulateTradeCurve(Side side, const std::vector<double>& quantities,
+        const std::vector<double>& volatilities, const std::vector<double>& feeTiers) {
+        return side == Side::Buy
+            ? SimulateTradeCurve<Side::Buy>(quantities, volatilities, feeTiers)
+            : SimulateTradeCurve<Side::Sell>(quantities, volatilities, feeTiers);
+    }
+
+    template <Side S>
+    std::vector<SimulationResults> SimulateTradeCurve(const std::vector<double>& quantities,
+        const std::vector<double>& volatilities, const std::vector<double>& feeTiers) {
+        try {
+            if (volatilities.size() != 1 && volatilities.size() != quantities.size()) {
+                throw std::invalid_argument("Volatilities must match quantities or hold a single value");
+            }
+            if (feeTiers.size() != 1 && feeTiers.size() != quantities.size()) {
+                throw std::invalid_argument("Fee tiers must match quantities or hold a single value");
+            }
+            if (!std::is_sorted(quantities.begin(), quantities.end())) {
+                throw std::invalid_argument("Quantities must be sorted in ascending order");
+            }
+
+            std::vector<SimulationResults> curve(quantities.size());
+            for (size_t i = 0; i < quantities.size(); ++i) {
+                ValidateInputs(quantities[i], volatilities[volatilities.size() == 1 ? 0 : i],
+                    feeTiers[feeTiers.size() == 1 ? 0 : i]);
+            }
+
+            OrderBook currentBook;
+
+            {
+                std::lock_guard<std::mutex> lock(books_.mutex);
+                if (const OrderBook* latest = LatestBook()) {
+                    currentBook = *latest;
+                }
+            }
+
+            if (currentBook.bids.empty() || currentBook.asks.empty()) {
+                return curve;
+            }
+
+            // Measure latency
+            auto start = std::chrono::steady_clock::now();
+
+            // Calculate slippage for every size in a single pass over the consumed side
+            std::vector<double> slippages = slippage_.template SlippageCurve<S>(quantities, currentBook, slippage_.template ReferencePrice<S>(currentBook));
+
+            // Evaluate the closed-form models over the whole curve with the SIMD kernels
+            std::vector<double> curveVolatilities(volatilities.size() == 1 ? quantities.size() : 0, volatilities[0]);
+            const std::vector<double>& vols = volatilities.size() == 1 ? curveVolatilities : volatilities;
+            std::vector<double> impacts(quantities.size());
+            std::vector<double> ratios(quantities.size());
+            impact_.ImpactBatch(quantities.data(), vols.data(), quantities.size(), impacts.data());
+            fill_.template TakerProbabilityBatch<S>(currentBook, quantities.data(), vols.data(), quantities.size(), ratios.data());
+
+            // Visible plus truncated size, to flag sizes the book cannot cover
+            double depth = SideTraits<S>::TailSize(currentBook);
+            for (const auto& level : SideTraits<S>::Levels(currentBook)) {
+                depth += level.second;
+            }
+
+            for (size_t i = 0; i < quantities.size(); ++i) {
+                double feeTier = feeTiers[feeTiers.size() == 1 ? 0 : i];
+
+                SimulationResults& results = curve[i];
+                results.slippage = slippages[i];
+                results.fees = quantities[i] * feeTier;
+                results.marketImpact = impacts[i];
+                results.makerTakerRatio = ratios[i];
+                results.netCost = results.slippage + results.fees + results.marketImpact;
+                results.volatility = vols[i];
+                results.unfilledQuantity = std::max(0.0, quantities[i] - depth);
+                slippageRegression_[static_cast<int>(S)].Observe(quantities[i], results.slippage);
+                results.estimatedSlippage = slippageRegression_[static_cast<int>(S)].Estimate(quantities[i]);
+            }
+
+            // Measure latency (whole curve)
+            auto end = std::chrono::steady_clock::now();
+            double latency = std::chrono::duration<double, std::milli>(end - start).count();
+            for (auto& results : curve) {
+                results.latency = latency;
+            }
+
+            return curve;
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Trade curve simulation error");
+            return std::vector<SimulationResults>();
+        }
+    }
+
+    // Feed every book published since the last call to the online models
+    void UpdateModels() {
+        UpdateMarketModels();
+        TrainFillModel();
+    }
+
+    // First half of UpdateModels: the consolidated book, impact calibration, slippage regression and volatility,
+    // under the model lock. The books are copied out first so this never holds the store's mutex against ingest;
+    // the maker/taker training they need is queued for TrainFillModel.
+    void UpdateMarketModels() {
+        std::vector<OrderBook> pending;
+        {
+            std::lock_guard<std::mutex> lock(books_.mutex);
+            auto it = books_.history.end();
+            while (it != books_.history.begin() && std::prev(it)->sequence > modelSequence_) {
+                --it;
+            }
+            pending.assign(it, books_.history.end());
+        }
+        for (OrderBook& book : pending) {
+            ObserveBook(std::move(book));
+        }
+    }
+
+    // Second half of UpdateModels: maker/taker probe labelling and SGD on the queued books. Runs on the fill
+    // policy's private copy without the model lock, so pooled jobs keep running; the new coefficients are handed
+    // over under the lock in one short step. The updating thread can call it after publishing its own results.
+    void TrainFillModel() {
+        if (fillBacklog_.empty()) {
+            return;
+        }
+        for (const FillSample& sample : fillBacklog_) {
+            fill_.OnBook(sample.book, sample.volatility);
+        }
+        fillBacklog_.clear();
+
+        std::unique_lock<std::shared_mutex> lock(modelMutex_);
+        fill_.Publish();
+    }
+
+    // Update the online models from one book. Books of other venues only reach the consolidated book, so price
+    // jumps between venues are not taken for market moves.
+    void OnBook(const OrderBook& book) {
+        ObserveBook(book);
+        TrainFillModel();
+    }
+
+    // Streaming volatility estimate, or the configured default until enough books were seen
+    double CurrentVolatility() const { return volatilityEstimator_.Volatility(); }
+
+    VolatilitySource CurrentVolatilitySource() const {
+        return volatilityEstimator_.IsReady() ? VolatilitySource::Live : VolatilitySource::Default;
+    }
+
+    // Externally observed execution: mid drift in the trade's direction after executing orderQty
+    void ObserveTrade(double orderQty, double impact) {
+        std::unique_lock<std::shared_mutex> lock(modelMutex_);
+        impact_.Observe(orderQty, impact);
+    }
+
+    // Policy instances, for configuration and inspection
+    SlippagePolicy& GetSlippagePolicy() { return slippage_; }
+    ImpactPolicy& GetImpactPolicy() { return impact_; }
+    FillPolicy& GetFillPolicy() { return fill_; }
+
+    // Distribution of execution cost for an Almgren-Chriss schedule from the latest mid, using the streaming
+    // volatility estimate and calibrated impact coefficients
+    MonteCarloResults SimulateCostDistribution(Side side, double quantity, double feeTier,
+        size_t paths = CONFIG_MONTE_CARLO_PATHS, uint64_t seed = CONFIG_MONTE_CARLO_SEED) {
+        try {
+            double volatility = CurrentVolatility();
+            ValidateInputs(quantity, volatility, feeTier);
+
+            double mid = 0;
+            {
+                std::lock_guard<std::mutex> lock(books_.mutex);
+                const OrderBook* latestBook = LatestBook();
+                if (!latestBook || latestBook->bids.empty() || latestBook->asks.empty()) {
+                    return MonteCarloResults();
+                }
+                const OrderBook& latest = *latestBook;
+                mid = (latest.bids[0].first + latest.asks[0].first) / 2;
+            }
+
+            // Relative volatility over the horizon to absolute price volatility per second
+            AlmgrenChrissParams params;
+            params.quantity = quantity;
+            params.volatility = volatility * mid / std::sqrt(CONFIG_IMPACT_TIME_HORIZON);
+            params.gamma = impact_.Gamma();
+            // The discrete schedule needs eta above half the permanent impact per slice
+            params.eta = std::max({ impact_.Eta(), params.gamma * params.timeHorizon / params.slices, CONFIG_CALIBRATION_MIN_ETA });
+
+            MonteCarloCostSimulator monteCarlo(params, side, mid, quantity * feeTier);
+            return monteCarlo.Run(paths, seed);
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Monte Carlo simulation error");
+            return MonteCarloResults();
+        }
+    }
+
+    // Approximate slippage from the size regression, without walking a book; safe to call from any thread
+    double EstimateSlippage(double quantity, Side side = Side::Buy) const {
+        return slippageRegression_[static_cast<int>(side)].Estimate(quantity);
+    }
+
+    // Cartesian product of quantities x volatilities x fee tiers against the latest books (most recent `books`
+    // of the history). Each book is walked once for all quantities; the model terms are then evaluated in
+    // tiles of CONFIG_GRID_TILE_QUANTITIES quantities across a pool of threads, reusing each tile's impact and
+    // maker/taker values for every fee tier while they are in cache. Do not update models concurrently.
+    GridResults SimulateGrid(Side side, const std::vector<double>& quantities, const std::vector<double>& volatilities,
+        const std::vector<double>& feeTiers, size_t books = 1) {
+        return side == Side::Buy
+            ? SimulateGrid<Side::Buy>(quantities, volatilities, feeTiers, books)
+            : SimulateGrid<Side::Sell>(quantities, volatilities, feeTiers, books);
+    }
+
+    template <Side S>
+    GridResults SimulateGrid(const std::vector<double>& quantities, const std::vector<double>& volatilities,
+        const std::vector<double>& feeTiers, size_t books = 1) {
+        GridResults grid;
+        try {
+            for (double quantity : quantities) {
+                for (double volatility : volatilities) {
+                    for (double feeTier : feeTiers) {
+                        ValidateInputs(quantity, volatility, feeTier);
+                    }
+                }
+            }
+
+            std::vector<OrderBook> bookRange;
+            {
+                std::lock_guard<std::mutex> lock(books_.mutex);
+                for (auto it = books_.history.rbegin(); it != books_.history.rend() && bookRange.size() < books; ++it) {
+                    if (it->venue == venue_) {
+                        bookRange.push_back(*it);
+                    }
+                }
+                std::reverse(bookRange.begin(), bookRange.end());
+            }
+            bookRange.erase(std::remove_if(bookRange.begin(), bookRange.end(),
+                [](const OrderBook& book) { return book.bids.empty() || book.asks.empty(); }), bookRange.end());
+
+            grid.quantities = quantities;
+            grid.volatilities = volatilities;
+            grid.feeTiers = feeTiers;
+            grid.books = bookRange.size();
+            grid.cells.resize(grid.books * quantities.size() * volatilities.size() * feeTiers.size());
+            if (grid.cells.empty()) {
+                return grid;
+            }
+
+            // Measure latency
+            auto start = std::chrono::steady_clock::now();
+
+            // Walk each book once over the quantities in ascending order
+            std::vector<size_t> order(quantities.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return quantities[a] < quantities[b]; });
+            std::vector<double> sortedQuantities(quantities.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                sortedQuantities[i] = quantities[order[i]];
+            }
+
+            // Size beyond a book's visible plus truncated depth is flagged per cell, as in SimulateTrade
+            std::vector<double> slippages(grid.books * quantities.size());
+            std::vector<double> unfilled(grid.books * quantities.size());
+            ParallelFor(grid.books, [&](size_t b) {
+                std::vector<double> curve = slippage_.template SlippageCurve<S>(sortedQuantities, bookRange[b],
+                    slippage_.template ReferencePrice<S>(bookRange[b]));
+                double depth = SideTraits<S>::TailSize(bookRange[b]);
+                for (const auto& level : SideTraits<S>::Levels(bookRange[b])) {
+                    depth += level.second;
+                }
+                for (size_t i = 0; i < order.size(); ++i) {
+                    slippages[b * quantities.size() + order[i]] = curve[i];
+                    unfilled[b * quantities.size() + order[i]] = std::max(0.0, sortedQuantities[i] - depth);
+                }
+            });
+
+            // Model terms per (book, quantity block) tile
+            size_t tileSize = CONFIG_GRID_TILE_QUANTITIES;
+            size_t blocks = (quantities.size() + tileSize - 1) / tileSize;
+            size_t volatilityCount = volatilities.size();
+            size_t feeCount = feeTiers.size();
+
+            ParallelFor(grid.books * blocks, [&](size_t tile) {
+                size_t b = tile / blocks;
+                size_t q0 = (tile % blocks) * tileSize;
+                size_t q1 = std::min(q0 + tileSize, quantities.size());
+                size_t pairs = (q1 - q0) * volatilityCount;
+
+                ScratchArena& arena = WorkStealingPool::Scratch();
+                ScratchArena::Scope scope(arena);
+                double* tileQuantities = arena.Allocate<double>(pairs);
+                double* tileVolatilities = arena.Allocate<double>(pairs);
+                double* impacts = arena.Allocate<double>(pairs);
+                double* ratios = arena.Allocate<double>(pairs);
+                for (size_t q = q0; q < q1; ++q) {
+                    for (size_t v = 0; v < volatilityCount; ++v) {
+                        tileQuantities[(q - q0) * volatilityCount + v] = quantities[q];
+                        tileVolatilities[(q - q0) * volatilityCount + v] = volatilities[v];
+                    }
+                }
+                impact_.ImpactBatch(tileQuantities, tileVolatilities, pairs, impacts);
+                fill_.template TakerProbabilityBatch<S>(bookRange[b], tileQuantities, tileVolatilities, pairs, ratios);
+
+                for (size_t q = q0; q < q1; ++q) {
+                    double slippage = slippages[b * quantities.size() + q];
+                    double unfilledQuantity = unfilled[b * quantities.size() + q];
+                    for (size_t v = 0; v < volatilityCount; ++v) {
+                        size_t pair = (q - q0) * volatilityCount + v;
+                        SimulationResults* cell = &grid.cells[((b * quantities.size() + q) * volatilityCount + v) * feeCount];
+                        for (size_t f = 0; f < feeCount; ++f) {
+                            cell[f].slippage = slippage;
+                            cell[f].fees = quantities[q] * feeTiers[f];
+                            cell[f].marketImpact = impacts[pair];
+                            cell[f].makerTakerRatio = ratios[pair];
+                            cell[f].netCost = slippage + cell[f].fees + impacts[pair];
+                            cell[f].volatility = volatilities[v];
+                            cell[f].unfilledQuantity = unfilledQuantity;
+                        }
+                    }
+                }
+            });
+
+            // Measure latency (whole grid)
+            auto end = std::chrono::steady_clock::now();
+            double latency = std::chrono::duration<double, std::milli>(end - start).count();
+            for (auto& cell : grid.cells) {
+                cell.latency = latency;
+            }
+
+            return grid;
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Grid simulation error");
+            return GridResults();
+        }
+    }
+
+    // Replay a TWAP, VWAP or POV schedule against the books recorded in the history, executing each child
+    // order against the book that was live at its time. Replay runs at CPU speed on a copy of the window.
+    // VWAP weights its slices by the estimated volume traded in each (a hindsight benchmark); POV trades
+    // participationRate of the volume estimated since the previous book. Children do not deplete later books.
+    ScheduleResults SimulateSchedule(const ExecutionSchedule& schedule) {
+        return schedule.side == Side::Buy ? SimulateSchedule<Side::Buy>(schedule) : SimulateSchedule<Side::Sell>(schedule);
+    }
+
+    template <Side S>
+    ScheduleResults SimulateSchedule(const ExecutionSchedule& schedule) {
+        try {
+            double volatility = CurrentVolatility();
+            ValidateInputs(schedule.quantity, volatility, schedule.feeTier);
+            if (schedule.duration <= 0) throw std::invalid_argument("Schedule duration must be positive");
+            if (schedule.type != ScheduleType::POV && schedule.slices == 0) throw std::invalid_argument("Schedule needs at least one slice");
+            if (schedule.type == ScheduleType::POV && (schedule.participationRate <= 0 || schedule.participationRate > 1)) {
+                throw std::invalid_argument("Participation rate must be between 0 and 1");
+            }
+
+            // Copy the window, plus the book live at its start
+            std::vector<OrderBook> books;
+            auto window = std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(schedule.duration));
+            {
+                std::lock_guard<std::mutex> lock(books_.mutex);
+                if (books_.history.empty()) {
+                    return ScheduleResults();
+                }
+                auto start = schedule.start == std::chrono::system_clock::time_point{} ? books_.history.front().timestamp : schedule.start;
+                auto first = std::upper_bound(books_.history.begin(), books_.history.end(), start,
+                    [](std::chrono::system_clock::time_point t, const OrderBook& book) { return t < book.timestamp; });
+                if (first != books_.history.begin()) --first;
+                while (first != books_.history.begin() && first->venue != venue_) --first;
+                auto last = std::upper_bound(first, books_.history.end(), start + window,
+                    [](std::chrono::system_clock::time_point t, const OrderBook& book) { return t < book.timestamp; });
+                books.assign(first, last);
+            }
+            books.erase(std::remove_if(books.begin(), books.end(), [this](const OrderBook& book) {
+                return book.venue != venue_ || book.bids.empty() || book.asks.empty();
+                }), books.end());
+            if (books.empty()) {
+                return ScheduleResults();
+            }
+
+            // Measure latency
+            auto replayStart = std::chrono::steady_clock::now();
+
+            ScheduleResults results;
+            auto start = std::max(books.front().timestamp, schedule.start);
+            results.arrivalPrice = (books.front().bids[0].first + books.front().asks[0].first) / 2;
+
+            // Book live at a given time: the last one published at or before it
+            auto liveBook = [&](std::chrono::system_clock::time_point t) -> const OrderBook& {
+                auto it = std::upper_bound(books.begin(), books.end(), t,
+                    [](std::chrono::system_clock::time_point time, const OrderBook& book) { return time < book.timestamp; });
+                return it == books.begin() ? books.front() : *std::prev(it);
+            };
+
+            auto execute = [&](const OrderBook& book, std::chrono::system_clock::time_point t, double quantity) {
+                if (quantity <= 0) {
+                    return;
+                }
+                ChildFill fill;
+                fill.timestamp = t;
+                fill.sequence = book.sequence;
+                fill.quantity = quantity;
+                fill.averagePrice = slippage_.template ReferencePrice<S>(book)
+                    + SideTraits<S>::Sign * slippage_.template Slippage<S>(quantity, book);
+                fill.marketImpact = impact_.Impact(quantity, volatility);
+                results.fills.push_back(fill);
+            };
+
+            if (schedule.type == ScheduleType::POV) {
+                double remaining = schedule.quantity;
+                for (size_t i = 1; i < books.size() && remaining > 0; ++i) {
+                    if (books[i].timestamp <= start) {
+                        continue;
+                    }
+                    double child = std::min(remaining, schedule.participationRate * EstimateTradedVolume(books[i - 1], books[i]));
+                    execute(books[i], books[i].timestamp, child);
+                    remaining -= child;
+                }
+            }
+            else {
+                // Slice weights: equal for TWAP, estimated traded volume per slice for VWAP
+                std::chrono::system_clock::duration sliceLength = window / static_cast<long long>(schedule.slices);
+                std::vector<double> weights(schedule.slices, 1.0);
+                if (schedule.type == ScheduleType::VWAP) {
+                    std::vector<double> volumes(schedule.slices, 0.0);
+                    for (size_t i = 1; i < books.size(); ++i) {
+                        if (books[i].timestamp <= start) {
+                            continue;
+                        }
+                        size_t slice = std::min(schedule.slices - 1,
+                            static_cast<size_t>((books[i].timestamp - start) / std::max(sliceLength, std::chrono::system_clock::duration(1))));
+                        volumes[slice] += EstimateTradedVolume(books[i - 1], books[i]);
+                    }
+                    if (std::accumulate(volumes.begin(), volumes.end(), 0.0) > 0) {
+                        weights = volumes;
+                    }
+                }
+
+                double totalWeight = std::accumulate(weights.begin(), weights.end(), 0.0);
+                for (size_t i = 0; i < schedule.slices; ++i) {
+                    auto t = start + sliceLength * static_cast<long long>(i);
+                    execute(liveBook(t), t, schedule.quantity * weights[i] / totalWeight);
+                }
+            }
+
+            // Aggregate the children
+            double notional = 0.0;
+            for (const ChildFill& fill : results.fills) {
+                results.filledQuantity += fill.quantity;
+                notional += fill.quantity * fill.averagePrice;
+                results.marketImpact += fill.marketImpact;
+            }
+            if (results.filledQuantity > 0) {
+                results.averagePrice = notional / results.filledQuantity;
+                results.slippage = SideTraits<S>::Sign * (results.averagePrice - results.arrivalPrice);
+            }
+            results.fees = results.filledQuantity * schedule.feeTier;
+            results.netCost = results.slippage + results.fees + results.marketImpact;
+
+            // Measure latency (whole replay)
+            auto replayEnd = std::chrono::steady_clock::now();
+            results.latency = std::chrono::duration<double, std::milli>(replayEnd - replayStart).count();
+
+            return results;
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Schedule simulation error");
+            return ScheduleResults();
+        }
+    }
+
+    // Order split across the venues of the consolidated book at the lowest cost including venue fees. Slippage
+    // is measured against the consolidated mid and impact on the parent quantity, since the child orders hit the
+    // same instrument at once. plan (optional) receives the per-venue allocation.
+    SimulationResults SimulateRoutedTrade(Side side, double quantity, double volatility, RoutingPlan* plan = nullptr) {
+        return side == Side::Buy
+            ? SimulateRoutedTrade<Side::Buy>(quantity, volatility, plan)
+            : SimulateRoutedTrade<Side::Sell>(quantity, volatility, plan);
+    }
+
+    template <Side S>
+    SimulationResults SimulateRoutedTrade(double quantity, double volatility, RoutingPlan* plan = nullptr) {
+        try {
+            ValidateInputs(quantity, volatility, 0.0);
+
+            SimulationResults results;
+            if (consolidated_.template Levels<Side::Buy>().empty() || consolidated_.template Levels<Side::Sell>().empty()) {
+                return results;
+            }
+
+            // Measure latency
+            auto start = std::chrono::steady_clock::now();
+
+            RoutingPlan routing = consolidated_.template Route<S>(quantity);
+            double mid = (consolidated_.template Levels<Side::Buy>()[0].price + consolidated_.template Levels<Side::Sell>()[0].price) / 2;
+
+            results.slippage = SideTraits<S>::Sign * (routing.averagePrice - mid);
+            results.fees = routing.fees;
+            results.marketImpact = impact_.Impact(quantity, volatility);
+            results.makerTakerRatio = fill_.template TakerProbability<S>(quantity, volatility, consolidatedSnapshot_);
+            results.netCost = results.slippage + results.fees + results.marketImpact;
+            results.volatility = volatility;
+            results.unfilledQuantity = routing.unfilledQuantity;
+
+            // Measure latency
+            auto end = std::chrono::steady_clock::now();
+            results.latency = std::chrono::duration<double, std::milli>(end - start).count();
+
+            if (plan) {
+                *plan = std::move(routing);
+            }
+            return results;
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "Routed trade simulation error");
+            return SimulationResults();
+        }
+    }
+
+    // Per-venue books and fees of the instrument, fed by OnBook; read it from the updating thread or a job
+    const ConsolidatedBook& GetConsolidatedBook() const { return consolidated_; }
+
+    // Fee tier of a venue for routing, charged per unit of quantity. Takes the model lock like OnBook, so it is
+    // safe while pooled jobs route.
+    void SetVenueFee(const std::string& venue, double feeTier) {
+        std::unique_lock<std::shared_mutex> lock(modelMutex_);
+        consolidated_.SetVenueFee(venue, feeTier);
+    }
+
+    // Queue job(simulator) on the work-stealing pool: a single simulation, a curve, a grid or a schedule replay.
+    // Jobs hold the model lock shared, so they run alongside each other while OnBook, UpdateModels and
+    // ObserveTrade wait for them and they wait for an update in progress. The updating thread itself may keep
+    // calling the simulator directly; the policies are configured before the first job.
+    template <typename Job>
+    auto Submit(Job job) -> std::future<std::invoke_result_t<Job&, BasicTradeSimulator&>> {
+        return WorkStealingPool::Default().Submit([this, job = std::move(job)]() mutable {
+            std::shared_lock<std::shared_mutex> lock(modelMutex_);
+            return job(*this);
+        });
+    }
+
+private:
+    // Book queued for maker/taker training with the volatility estimate after it
+    struct FillSample {
+        OrderBook book;
+        double volatility = 0.0;
+    };
+
+    // Model updates that need the model lock; queues the book for TrainFillModel
+    void ObserveBook(OrderBook book) {
+        std::unique_lock<std::shared_mutex> lock(modelMutex_);
+        modelSequence_ = std::max(modelSequence_, book.sequence);
+        if (consolidated_.Update(book)) {
+            consolidatedSnapshot_ = consolidated_.Snapshot();
+        }
+        if (book.venue != venue_ || book.bids.empty() || book.asks.empty()) {
+            return;
+        }
+
+        CalibrateImpact(book);
+        ObserveSlippageLadder(book);
+        volatilityEstimator_.Update((book.bids[0].first + book.asks[0].first) / 2, book.timestamp);
+        fillBacklog_.push_back({ std::move(book), CurrentVolatility() });
+    }
+
+    // Latest book of the simulated venue; books_.mutex must be held
+    const OrderBook* LatestBook() const {
+        for (auto it = books_.history.rbegin(); it != books_.history.rend(); ++it) {
+            if (it->venue == venue_) {
+                return &*it;
+            }
+        }
+        return nullptr;
+    }
+
+    template <Side S>
+    SimulationResults SimulateOnBook(const OrderBook& book, double quantity, double volatility, double feeTier,
+        size_t* levelsTouched) {
+        SimulationResults results;
+
+        // Measure latency
+        auto start = std::chrono::steady_clock::now();
+
+        // Calculate slippage
+        size_t touched = 0;
+        results.slippage = slippage_.template Slippage<S>(quantity, book, &touched);
+        slippageRegression_[static_cast<int>(S)].Observe(quantity, results.slippage);
+        if (levelsTouched) {
+            *levelsTouched = touched;
+        }
+
+        // Flag size the truncated tail cannot cover either
+        const auto& levels = SideTraits<S>::Levels(book);
+        if (touched > levels.size()) {
+            double depth = SideTraits<S>::TailSize(book);
+            for (const auto& level : levels) {
+                depth += level.second;
+            }
+            results.unfilledQuantity = std::max(0.0, quantity - depth);
+        }
+
+        // Fees, impact, maker/taker ratio and net cost
+        ApplyModels<S>(results, book, quantity, volatility, feeTier);
+
+        // Measure latency
+        auto end = std::chrono::steady_clock::now();
+        results.latency = std::chrono::duration<double, std::milli>(end - start).count();
+
+        return results;
+    }
+
+    // Everything except slippage, which needs the book walk
+    template <Side S>
+    void ApplyModels(SimulationResults& results, const OrderBook& book, double quantity, double volatility, double feeTier) {
+        // Calculate fees
+        results.fees = quantity * feeTier;
+
+        // Calculate market impact (Almgren-Chriss model)
+        results.marketImpact = impact_.Impact(quantity, volatility);
+
+        // Calculate maker/taker ratio
+        results.makerTakerRatio = fill_.template TakerProbability<S>(quantity, volatility, book);
+
+        // Calculate net cost
+        results.netCost = results.slippage + results.fees + results.marketImpact;
+        results.volatility = volatility;
+        results.estimatedSlippage = slippageRegression_[static_cast<int>(S)].Estimate(quantity);
+    }
+
+    void ValidateInputs(double quantity, double volatility, double feeTier) {
+        if (quantity <= 0) throw std::invalid_argument("Quantity must be positive");
+        if (volatility < 0) throw std::invalid_argument("Volatility cannot be negative");
+        if (feeTier < 0 || feeTier > 1) throw std::invalid_argument("Fee tier must be between 0 and 1");
+    }
+
+    // Realised impact: net volume taken between the previous book and this one against the mid drift that followed.
+    // The static book walk is already charged as slippage, so it must not feed the impact model.
+    void CalibrateImpact(const OrderBook& book) {
+        if (!previousBook_.bids.empty() && !previousBook_.asks.empty()) {
+            double net = EstimateTradedVolume<Side::Buy>(previousBook_, book)
+                - EstimateTradedVolume<Side::Sell>(previousBook_, book);
+            if (net != 0) {
+                double drift = (book.bids[0].first + book.asks[0].first) / 2
+                    - (previousBook_.bids[0].first + previousBook_.asks[0].first) / 2;
+                impact_.Observe(std::abs(net), net > 0 ? drift : -drift);
+            }
+        }
+        previousBook_ = book;
+    }
+
+    // With slippage measured against mid, a ladder of probe sizes on both sides feeds the slippage regressions
+    void ObserveSlippageLadder(const OrderBook& book) {
+        static const std::vector<double> probeScales = { 0.25, 0.5, 1.0, 2.0, 4.0 };
+        if constexpr (SlippagePolicy::Reference != SlippageReference::Mid) {
+            return;
+        }
+
+        double askDepth = 0;
+        double bidDepth = 0;
+        for (const auto& ask : book.asks) askDepth += ask.second;
+        for (const auto& bid : book.bids) bidDepth += bid.second;
+
+        // Only sizes both sides can fill completely are informative
+        std::vector<double> probes;
+        for (double scale : probeScales) {
+            double probe = scale * CONFIG_DEFAULT_QUANTITY;
+            if (probe <= askDepth && probe <= bidDepth) {
+                probes.push_back(probe);
+            }
+        }
+        if (probes.empty()) {
+            return;
+        }
+
+        double mid = (book.bids[0].first + book.asks[0].first) / 2;
+        std::vector<double> buys = slippage_.template SlippageCurve<Side::Buy>(probes, book, mid);
+        std::vector<double> sells = slippage_.template SlippageCurve<Side::Sell>(probes, book, mid);
+        for (size_t i = 0; i < probes.size(); ++i) {
+            slippageRegression_[static_cast<int>(Side::Buy)].Observe(probes[i], buys[i]);
+            slippageRegression_[static_cast<int>(Side::Sell)].Observe(probes[i], sells[i]);
+        }
+    }
+
+    double CalculateMarketImpact(double orderQty, double volatility) {
+        return impact_.Impact(orderQty, volatility);
+    }
+
+    BookStore& books_;
+    std::string venue_; // Venue of the single-venue simulations and the online models
+
+    // Model policies
+    SlippagePolicy slippage_;
+    ImpactPolicy impact_;
+    FillPolicy fill_;
+
+    // Online estimators
+    uint64_t modelSequence_ = 0; // Last book sequence fed to the models
+    VolatilityEstimator volatilityEstimator_;
+    SlippageRegression slippageRegression_[2]; // Indexed by Side
+    std::vector<FillSample> fillBacklog_; // Books awaiting TrainFillModel; updating thread only
+    ConsolidatedBook consolidated_;
+    OrderBook consolidatedSnapshot_; // consolidated_.Snapshot() as of its last change
+    OrderBook previousBook_; // Last book fed to the impact calibration
+
+    // Exclusive for model updates, shared by pooled jobs
+    mutable std::shared_mutex modelMutex_;
+};
+
+// Default model combination
+using TradeSimulator = BasicTradeSimulator<BookWalkSlippage<>, CalibratedImpact, OnlineMakerTaker>;
+
+// Trading Engine
+// One feed-to-results pipeline: book ring, book store, simulator, results, latency histograms and the ingest and
+// simulation threads. Engines share no mutable state, so a process can run several (one per core or instrument).
+class alignas(64) TradingEngine {
+public:
+    explicit TradingEngine(FeedEndpoint endpoint = FeedEndpoint(), ThreadPlacement placement = ThreadPlacement())
+        : endpoint_(std::move(endpoint)),
+        placement_(placement),
+        bookRing_(CONFIG_BOOK_QUEUE_CAPACITY, CONFIG_BOOK_RING_BLOCK_ON_FULL ? RingFullPolicy::Block : RingFullPolicy::Drop),
+        wsHandler_(ioc_, endpoint_, bookRing_, latency_, stopping_),
+        simulationConsumer_(bookRing_.AddConsumer()) {
+    }
+
+    ~TradingEngine() { Stop(); }
+
+    TradingEngine(const TradingEngine&) = delete;
+    TradingEngine& operator=(const TradingEngine&) = delete;
+
+    // Register extra BookRing() consumers before starting
+    void Start() {
+        wsThread_ = std::thread([this]() {
+            ConfigureCurrentThread("ts-io", placement_.ioCpu);
+            bookRing_.PlaceSlots();
+            wsHandler_.Start();
+            ioc_.run();
+            });
+        simulationThread_ = std::thread(&TradingEngine::SimulationWorker, this);
+    }
+
+    void Stop() {
+        if (stopping_.exchange(true)) {
+            return;
+        }
+        bookRing_.Close();
+        if (wsThread_.joinable()) {
+            wsHandler_.Stop();
+            wsThread_.join();
+        }
+        if (simulationThread_.joinable()) {
+            simulationThread_.join();
+        }
+
+        // Release Submit callers waiting on a simulator that was never built
+        simulatorReady_.store(true, std::memory_order_release);
+        simulatorReady_.notify_all();
+    }
+
+    SimulationResults Results() const {
+        std::lock_guard<std::mutex> lock(resultsMutex_);
+        return results_;
+    }
+
+    // On-demand requests (curves, grids, schedule replays) run on the pool against the live models while the
+    // simulation thread keeps refreshing the standing request and updating the models. Waits until Start has built
+    // the simulator.
+    template <typename Job>
+    auto Submit(Job job) {
+        return Simulator().Submit(std::move(job));
+    }
+
+    // Ingest depth of one instrument (0 keeps every level); safe while the engine runs
+    void SetMaxDepth(std::string symbol, size_t levels) {
+        wsHandler_.SetMaxDepth(std::move(symbol), levels);
+    }
+
+    // Routing fee of a venue; safe while the engine runs
+    void SetVenueFee(const std::string& venue, double feeTier) {
+        Simulator().SetVenueFee(venue, feeTier);
+    }
+
+    BookStore& Books() { return books_; }
+    BroadcastRing<OrderBook>& BookRing() { return bookRing_; }
+    LatencyMonitor& Latency() { return latency_; }
+    const LatencyMonitor& Latency() const { return latency_; }
+    const FeedEndpoint& Endpoint() const { return endpoint_; }
+
+private:
+    // Blocks until the simulation thread has built the simulator
+    TradeSimulator& Simulator() {
+        simulatorReady_.wait(false, std::memory_order_acquire);
+        if (!simulator_) {
+            throw std::runtime_error("Trading engine stopped before its simulator was built");
+        }
+        return *simulator_;
+    }
+
+    void SimulationWorker() {
+        // Pin first, so the history and the simulator's models are allocated on the worker's node
+        ConfigureCurrentThread("ts-sim", placement_.simulationCpu);
+        TradeSimulator& simulator = simulator_.emplace(books_);
+        simulatorReady_.store(true, std::memory_order_release);
+        simulatorReady_.notify_all();
+        StandingSimulation request;
+
+        while (!stopping_) {
+            // Sleep until the ingest thread publishes a book, or spin on pinned cores
+            if (CONFIG_WORKER_BUSY_POLL) {
+                while (bookRing_.Empty(simulationConsumer_) && !stopping_) {
+                    CpuRelax();
+                }
+            }
+            else {
+                bookRing_.Wait(simulationConsumer_);
+            }
+
+            if (stopping_) return;
+
+            // Copy every new book into the history the simulator reads
+            if (bookRing_.Consume(simulationConsumer_, [this](const OrderBook& book) { books_.Append(book); }) == 0) {
+                continue;
+            }
+
+            try {
+                // Update the market models with the new books; maker/taker training waits until after the refresh
+                simulator.UpdateMarketModels();
+
+                // Simulate trade, skipping books whose changes cannot affect the fill
+                bool updated = false;
+                {
+                    StageTimer simulateTimer(latency_.Histogram(LatencyStage::Simulate));
+                    updated = simulator.Refresh(request);
+                }
+
+                // Update results
+                if (updated) {
+                    std::lock_guard<std::mutex> lock(resultsMutex_);
+                    results_ = request.results;
+                }
+
+                // Train the maker/taker model off the refresh path and outside the model lock
+                simulator.TrainFillModel();
+            }
+            catch (const std::exception& e) {
+                ExceptionHandler::HandleException(e, "Simulation worker error");
+            }
+        }
+    }
+
+    FeedEndpoint endpoint_;
+    ThreadPlacement placement_;
+    std::atomic<bool> stopping_{ false };
+    LatencyMonitor latency_;
+    BookStore books_;
+    BroadcastRing<OrderBook> bookRing_;
+    boost::asio::io_context ioc_;
+    WebSocketHandler wsHandler_;
+    size_t simulationConsumer_;
+    std::optional<TradeSimulator> simulator_; // Built by the pinned simulation thread; models read by pooled jobs
+    std::atomic<bool> simulatorReady_{ false }; // simulator_ is built, or will never be
+
+    mutable std::mutex resultsMutex_;
+    SimulationResults results_;
+
+    std::thread wsThread_;
+    std::thread simulationThread_;
+};
+
+// UI Component
+class TradeSimulatorUI {
+public:
+    void Render(const TradingEngine& engine) {
+        try {
+            system("clear");
+
+            std::cout << "GoQuant Trade Simulator" << std::endl;
+            std::cout << "----------------------" << std::endl;
+            std::cout << "Exchange: " << CONFIG_EXCHANGE << std::endl;
+            std::cout << "Asset: " << CONFIG_ASSET << std::endl;
+
+            std::cout << "\nInput Parameters:" << std::endl;
+            std::cout << "Order Type: Market" << std::endl;
+            std::cout << "Quantity: " << CONFIG_DEFAULT_QUANTITY << " USD" << std::endl;
+
+            SimulationResults results = engine.Results();
+
+            std::cout << "Volatility: " << results.volatility;
+            switch (results.volatilitySource) {
+            case VolatilitySource::Live: std::cout << " (live estimate)"; break;
+            case VolatilitySource::Default: std::cout << " (configured default, estimator warming up)"; break;
+            default: std::cout << " (fixed input)"; break;
+            }
+            std::cout << std::endl;
+            std::cout << "Fee Tier: " << CONFIG_DEFAULT_FEE_TIER * 100 << "%" << std::endl;
+
+            std::cout << "\nOutput Parameters:" << std::endl;
+            std::cout << "Expected Slippage: " << results.slippage << std::endl;
+            std::cout << "Regression Slippage Estimate: " << results.estimatedSlippage << std::endl;
+            std::cout << "Expected Fees: " << results.fees << std::endl;
+            std::cout << "Market Impact: " << results.marketImpact << std::endl;
+            std::cout << "Net Cost: " << results.netCost << std::endl;
+            std::cout << "Maker/Taker Ratio: " << results.makerTakerRatio << std::endl;
+            std::cout << "Latency: " << results.latency << " ms" << std::endl;
+
+            if (results.latency > CONFIG_MAX_LATENCY) {
+                std::cout << "\nWarning: High latency detected!" << std::endl;
+            }
+            if (results.unfilledQuantity > 0) {
+                std::cout << "Warning: " << results.unfilledQuantity << " exceeds the book depth and is priced at the tail penalty" << std::endl;
+            }
+
+            std::cout << "\nStage Latency (us): p50 / p99 / p99.9 / max (count)" << std::endl;
+            for (size_t i = 0; i < static_cast<size_t>(LatencyStage::Count); ++i) {
+                auto stage = static_cast<LatencyStage>(i);
+                const LatencyHistogram& histogram = engine.Latency().Histogram(stage);
+                std::cout << LatencyMonitor::StageName(stage) << ": "
+                    << histogram.Percentile(50) / 1000.0 << " / "
+                    << histogram.Percentile(99) / 1000.0 << " / "
+                    << histogram.Percentile(99.9) / 1000.0 << " / "
+                    << histogram.Max() / 1000.0 << " (" << histogram.Count() << ")" << std::endl;
+            }
+
+            std::cout << "\nPress Ctrl+C to exit..." << std::endl;
+
+        }
+        catch (const std::exception& e) {
+            ExceptionHandler::HandleException(e, "UI rendering error");
+        }
+    }
+};
+
+// Unit Tests
+TEST(TradeSimulatorTest, SlippageCalculation) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    book.asks.push_back({ 101.0, 5.0 });
+    book.asks.push_back({ 102.0, 10.0 });
+
+    books.Append(book);
+
+    // Buying 7 walks 5 @ 101 and 2 @ 102 for an average of 101.2857; slippage is measured from the 100.5 mid
+    SimulationResults results = simulator.SimulateTrade(7.0, 0.01, 0.001);
+    EXPECT_NEAR(results.slippage, 0.7857, 0.001);
+}
+
+TEST(TradeSimulatorTest, MarketImpactCalculation) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    double impact = simulator.CalculateMarketImpact(100.0, 0.02);
     EXPECT_GT(impact, 0.0);
 }
 
+TEST(TradeSimulatorTest, CostCurveMatchesSingleSimulations) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    book.asks.push_back({ 101.0, 5.0 });
+    book.asks.push_back({ 102.0, 10.0 });
+    book.asks.push_back({ 103.0, 20.0 });
+
+    books.Append(book);
+
+    std::vector<double> quantities = { 2.0, 5.0, 7.0, 15.0, 30.0 };
+    auto curve = simulator.SimulateTradeCurve(quantities, { 0.02 }, { 0.001 });
+
+    ASSERT_EQ(curve.size(), quantities.size());
+    for (size_t i = 0; i < quantities.size(); ++i) {
+        SimulationResults single = simulator.SimulateTrade(quantities[i], 0.02, 0.001);
+        EXPECT_NEAR(curve[i].slippage, single.slippage, 1e-9);
+        EXPECT_NEAR(curve[i].netCost, single.netCost, 1e-9);
+    }
+}
+
+TEST(TradeSimulatorTest, SellSlippageAgainstReferences) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 4.0 });
+    book.bids.push_back({ 99.0, 10.0 });
+    book.asks.push_back({ 101.0, 5.0 });
+
+    books.Append(book);
+
+    // Sell 8: 4 @ 100 and 4 @ 99, average 99.5
+    SimulationResults mid = simulator.SimulateTrade(Side::Sell, 8.0, 0.01, 0.001);
+    EXPECT_NEAR(mid.slippage, 100.5 - 99.5, 1e-9);
+
+    BasicTradeSimulator<BookWalkSlippage<SlippageReference::Touch>, CalibratedImpact, OnlineMakerTaker> touchSimulator(books);
+    SimulationResults touch = touchSimulator.SimulateTrade(Side::Sell, 8.0, 0.01, 0.001);
+    EXPECT_NEAR(touch.slippage, 100.0 - 99.5, 1e-9);
+
+    BasicTradeSimulator<BookWalkSlippage<SlippageReference::Arrival>, CalibratedImpact, OnlineMakerTaker> arrivalSimulator(books);
+    arrivalSimulator.GetSlippagePolicy().SetArrivalPrice(99.0);
+    SimulationResults arrival = arrivalSimulator.SimulateTrade(Side::Sell, 8.0, 0.01, 0.001);
+    EXPECT_NEAR(arrival.slippage, 99.0 - 99.5, 1e-9);
+}
+
+TEST(TradeSimulatorTest, StandingSimulationSkipsDeepChanges) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    book.asks.push_back({ 101.0, 5.0 });
+    book.asks.push_back({ 102.0, 10.0 });
+    book.asks.push_back({ 103.0, 10.0 });
+
+    auto publish = [&books](OrderBook next) {
+        StampBook(next, &books.history.back(), &books.history.back());
+        books.Append(next);
+    };
+
+    books.Append(book);
+    publish(book);
+
+    StandingSimulation request;
+    request.quantity = 7.0;
+    ASSERT_TRUE(simulator.Refresh(request));
+    EXPECT_EQ(request.levelsTouched, 2u);
+
+    // Change beyond the levels the 7-lot fill reaches
+    book.asks[2].second = 50.0;
+    publish(book);
+    EXPECT_FALSE(simulator.Refresh(request));
+
+    // Change inside the filled range
+    book.asks[1].second = 1.0;
+    publish(book);
+    EXPECT_TRUE(simulator.Refresh(request));
+}
+
+TEST(TradeSimulatorTest, StaticPoliciesMatchUntrainedDefaults) {
+    BookStore books;
+    BasicTradeSimulator<BookWalkSlippage<>, StaticImpact, StaticMakerTaker> simulator(books);
+    TradeSimulator defaults(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    book.asks.push_back({ 101.0, 5.0 });
+    book.asks.push_back({ 102.0, 10.0 });
+
+    books.Append(book);
+
+    SimulationResults fixed = simulator.SimulateTrade(Side::Buy, 7.0, 0.02, 0.001);
+    SimulationResults online = defaults.SimulateTrade(Side::Buy, 7.0, 0.02, 0.001);
+    EXPECT_DOUBLE_EQ(fixed.netCost, online.netCost);
+    EXPECT_DOUBLE_EQ(fixed.makerTakerRatio, online.makerTakerRatio);
+}
+
+TEST(AlmgrenChrissTest, ClosedFormMatchesTrajectory) {
+    AlmgrenChrissParams params;
+    params.quantity = 1e6;
+    params.volatility = 0.95;
+    params.eta = 2.5e-6;
+    params.gamma = 2.5e-7;
+    params.epsilon = 0.0625;
+    params.riskAversion = 1e-6;
+    params.timeHorizon = 5.0;
+    params.slices = 5;
+
+    AlmgrenChrissModel model(params);
+    ExecutionPlan plan = model.Schedule();
+
+    ASSERT_EQ(plan.holdings.size(), 6u);
+    EXPECT_DOUBLE_EQ(plan.holdings.front(), params.quantity);
+    EXPECT_DOUBLE_EQ(plan.holdings.back(), 0.0);
+
+    // Direct sums over the discrete schedule
+    double tau = params.timeHorizon / params.slices;
+    double etaTilde = params.eta - 0.5 * params.gamma * tau;
+    double cost = 0.5 * params.gamma * params.quantity * params.quantity + params.epsilon * params.quantity;
+    double variance = 0.0;
+    for (int j = 0; j < params.slices; ++j) {
+        cost += etaTilde / tau * plan.trades[j] * plan.trades[j];
+        variance += params.volatility * params.volatility * tau * plan.holdings[j + 1] * plan.holdings[j + 1];
+    }
+    EXPECT_NEAR(plan.expectedCost, cost, 1e-9 * cost);
+    EXPECT_NEAR(plan.variance, variance, 1e-9 * variance);
+
+    // Less risk aversion trades slower: higher variance, lower expected cost
+    auto frontier = AlmgrenChrissModel::EfficientFrontier(params, { 1e-5, 1e-6, 1e-7 });
+    EXPECT_LT(frontier[0].variance, frontier[2].variance);
+    EXPECT_GT(frontier[0].expectedCost, frontier[2].expectedCost);
+}
+
+TEST(AlmgrenChrissTest, HighUrgencyFrontLoads) {
+    AlmgrenChrissParams params;
+    params.quantity = 1e6;
+    params.volatility = 0.95;
+    params.eta = 2.5e-6;
+    params.gamma = 2.5e-7;
+    params.riskAversion = 1.0;
+    params.timeHorizon = 5.0;
+    params.slices = 1000; // kappa T is in the thousands, far past where sinh(2 kappa T) overflows
+
+    AlmgrenChrissModel model(params);
+    ExecutionPlan plan = model.Schedule();
+
+    ASSERT_TRUE(std::isfinite(plan.expectedCost));
+    ASSERT_TRUE(std::isfinite(plan.variance));
+    EXPECT_LT(plan.holdings[1], 0.2 * params.quantity);
+    for (size_t j = 1; j < plan.trades.size(); ++j) {
+        EXPECT_LE(plan.trades[j], plan.trades[j - 1]);
+    }
+
+    double tau = params.timeHorizon / params.slices;
+    double etaTilde = params.eta - 0.5 * params.gamma * tau;
+    double cost = 0.5 * params.gamma * params.quantity * params.quantity;
+    double variance = 0.0;
+    for (int j = 0; j < params.slices; ++j) {
+        cost += etaTilde / tau * plan.trades[j] * plan.trades[j];
+        variance += params.volatility * params.volatility * tau * plan.holdings[j + 1] * plan.holdings[j + 1];
+    }
+    EXPECT_NEAR(plan.expectedCost, cost, 1e-9 * cost);
+    EXPECT_NEAR(plan.variance, variance, 1e-9 * variance);
+}
+
+TEST(ImpactCalibratorTest, RecoversCoefficients) {
+    ImpactCalibrator calibrator;
+    double eta = 0.003;
+    double gamma = 0.00002;
+
+    for (int i = 0; i < 500; ++i) {
+        double q = 10.0 + (i % 40) * 10.0;
+        calibrator.Observe(q, eta * q + gamma * q * q);
+    }
+
+    ASSERT_TRUE(calibrator.IsCalibrated());
+    EXPECT_NEAR(calibrator.Eta(), eta, 1e-6);
+    EXPECT_NEAR(calibrator.Gamma(), gamma, 1e-8);
+}
+
+TEST(ImpactCalibratorTest, CalibratesFromRealisedDriftAndFeedsMonteCarlo) {
+    BookStore books;
+    TradeSimulator simulator(books);
+
+    // Each book, a buyer lifts the whole touch of q lots and the mid then rises by eta q + gamma q^2
+    const double eta = 0.004;
+    const double gamma = 0.0001;
+    double touch = 100.1;
+    for (int i = 0; i < CONFIG_CALIBRATION_MIN_SAMPLES + 20; ++i) {
+        double quantity = 5.0 + 5.0 * (i % 4);
+        OrderBook book;
+        book.sequence = i + 1;
+        book.bids.push_back({ 100.0, 50.0 });
+        book.asks.push_back({ touch, quantity });
+        book.asks.push_back({ touch + 1.0, 100.0 });
+        books.Append(book);
+        touch += 2 * (eta * quantity + gamma * quantity * quantity);
+    }
+    simulator.UpdateModels();
+
+    const ImpactCalibrator& calibrator = simulator.GetImpactPolicy().Calibrator();
+    ASSERT_TRUE(calibrator.IsCalibrated());
+    EXPECT_NEAR(calibrator.Eta(), eta, 1e-4);
+    EXPECT_NEAR(calibrator.Gamma(), gamma, 1e-5);
+
+    // Adverse drift pushes the raw fit negative; the coefficients stay usable by the solver
+    for (int i = 0; i < 500; ++i) {
+        double quantity = 1.0 + i % 20;
+        simulator.ObserveTrade(quantity, -0.01 * quantity);
+    }
+    EXPECT_GE(calibrator.Eta(), 0.0);
+    EXPECT_GE(calibrator.Gamma(), 0.0);
+
+    MonteCarloResults results = simulator.SimulateCostDistribution(Side::Buy, 10.0, 0.001, 1000);
+    EXPECT_EQ(results.paths, 1000u);
+    EXPECT_TRUE(std::isfinite(results.meanCost));
+}
+
+TEST(VolatilityEstimatorTest, TracksRandomWalkVariance) {
+    VolatilityEstimator estimator;
+    auto timestamp = std::chrono::system_clock::time_point();
+    double logMid = std::log(100.0);
+    double step = 0.001; // Log return per one-second tick
+    uint32_t state = 12345;
+
+    EXPECT_DOUBLE_EQ(estimator.Volatility(), CONFIG_DEFAULT_VOLATILITY);
+
+    for (int i = 0; i < 20000; ++i) {
+        state = state * 1664525u + 1013904223u;
+        logMid += (state >> 31) ? step : -step;
+        timestamp += std::chrono::seconds(1);
+        estimator.Update(std::exp(logMid), timestamp);
+    }
+
+    ASSERT_TRUE(estimator.IsReady());
+    EXPECT_NEAR(std::sqrt(estimator.EwmaVariance()), step, 0.1 * step);
+    EXPECT_NEAR(std::sqrt(estimator.RealizedVariance()), step, 0.3 * step);
+}
+
+TEST(VolatilityEstimatorTest, ResultsReportTheirVolatilitySource) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.sequence = 1;
+    book.bids.push_back({ 100.0, 10.0 });
+    book.asks.push_back({ 101.0, 10.0 });
+    books.Append(book);
+    simulator.UpdateModels();
+
+    SimulationResults warmingUp = simulator.SimulateTrade(Side::Buy, 5.0, 0.001);
+    EXPECT_EQ(warmingUp.volatilitySource, VolatilitySource::Default);
+    EXPECT_DOUBLE_EQ(warmingUp.volatility, CONFIG_DEFAULT_VOLATILITY);
+
+    SimulationResults explicitInput = simulator.SimulateTrade(Side::Buy, 5.0, 0.05, 0.001);
+    EXPECT_EQ(explicitInput.volatilitySource, VolatilitySource::Input);
+    EXPECT_DOUBLE_EQ(explicitInput.volatility, 0.05);
+}
+
+TEST(MakerTakerModelTest, LearnsFromBookStream) {
+    MakerTakerModel model;
+    OrderBook book;
+    book.bids = { { 100.0, 50.0 }, { 99.5, 50.0 } };
+    book.asks = { { 100.5, 50.0 }, { 101.0, 50.0 } };
+
+    // A static book never fills passive orders: everything is labelled taker
+    for (int i = 0; i < 2000; ++i) {
+        model.OnBook(book, 0.02);
+    }
+    ASSERT_TRUE(model.IsTrained());
+
+    double touchDepth = 1.0;
+    auto features = MakerTakerModel::ExtractBookFeatures<Side::Buy>(book, 0.02, touchDepth);
+    features[MakerTakerModel::SizeRatio] = CONFIG_DEFAULT_QUANTITY / touchDepth;
+    EXPECT_GT(model.Predict(features), 0.95);
+
+    std::vector<double> quantities = { 10.0, 100.0, 400.0 };
+    std::vector<double> volatilities(quantities.size(), 0.02);
+    std::vector<double> batch(quantities.size());
+    model.PredictBatch(features, quantities.data(), volatilities.data(), quantities.size(), touchDepth, batch.data());
+    for (size_t i = 0; i < quantities.size(); ++i) {
+        features[MakerTakerModel::SizeRatio] = quantities[i] / touchDepth;
+        EXPECT_NEAR(batch[i], model.Predict(features), 1e-12);
+    }
+}
+
+TEST(MakerTakerModelTest, SimulatorPublishesTrainedCoefficients) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.bids = { { 100.0, 50.0 }, { 99.5, 50.0 } };
+    book.asks = { { 100.5, 50.0 }, { 101.0, 50.0 } };
+    for (int i = 0; i < 400; ++i) {
+        book.sequence = i + 1;
+        books.Append(book);
+    }
+
+    // Market models update first; pricing keeps the old maker/taker coefficients until the training step publishes
+    simulator.UpdateMarketModels();
+    EXPECT_FALSE(simulator.GetFillPolicy().Model().IsTrained());
+    double untrained = simulator.SimulateTrade(Side::Buy, CONFIG_DEFAULT_QUANTITY, 0.02, 0.001).makerTakerRatio;
+
+    simulator.TrainFillModel();
+    ASSERT_TRUE(simulator.GetFillPolicy().Model().IsTrained());
+    EXPECT_NE(simulator.SimulateTrade(Side::Buy, CONFIG_DEFAULT_QUANTITY, 0.02, 0.001).makerTakerRatio, untrained);
+
+    // Training the books one at a time reaches the same coefficients
+    TradeSimulator stepwise(books);
+    for (const OrderBook& each : books.history) {
+        stepwise.OnBook(each);
+    }
+    EXPECT_EQ(stepwise.GetFillPolicy().Model().Weights(), simulator.GetFillPolicy().Model().Weights());
+}
+
+TEST(MakerTakerModelTest, DepletionMustClearTheQueueAhead) {
+    MakerTakerModel model;
+    OrderBook full;
+    full.bids = { { 100.0, 1000.0 }, { 99.5, 1000.0 } };
+    full.asks = { { 100.5, 1000.0 }, { 101.0, 1000.0 } };
+    OrderBook depleted = full;
+    depleted.bids[0].second = 900.0;
+    depleted.asks[0].second = 900.0;
+
+    // Every other book trades 100 off each touch and the queue refills behind the probes. Within the horizon that
+    // never works through the 1000 queued ahead, so even probes smaller than one depletion stay unfilled.
+    for (int i = 0; i < 2000; ++i) {
+        model.OnBook(i % 2 ? depleted : full, 0.02);
+    }
+    ASSERT_TRUE(model.IsTrained());
+
+    double touchDepth = 1.0;
+    auto features = MakerTakerModel::ExtractBookFeatures<Side::Buy>(full, 0.02, touchDepth);
+    features[MakerTakerModel::SizeRatio] = 0.25 * CONFIG_DEFAULT_QUANTITY / touchDepth;
+    EXPECT_GT(model.Predict(features), 0.9);
+}
+
+TEST(SlippageRegressionTest, FitsLinearRelationship) {
+    SlippageRegression regression;
+    for (int i = 0; i < 200; ++i) {
+        double size = 10.0 * (1 + i % 20);
+        regression.Observe(size, 0.05 + 0.002 * size);
+    }
+
+    ASSERT_TRUE(regression.IsReady());
+    EXPECT_NEAR(regression.Slope(), 0.002, 1e-9);
+    EXPECT_NEAR(regression.Intercept(), 0.05, 1e-7);
+    EXPECT_NEAR(regression.Estimate(500.0), 1.05, 1e-6);
+}
+
+TEST(MonteCarloTest, ReproducibleAndUnbiased) {
+    AlmgrenChrissParams params;
+    params.quantity = 1000.0;
+    params.volatility = 0.5;
+    params.eta = 0.05;
+    params.gamma = 0.001;
+    params.timeHorizon = 10.0;
+    params.slices = 10;
+
+    MonteCarloCostSimulator monteCarlo(params, Side::Sell, 100.0, 1.0);
+    MonteCarloResults first = monteCarlo.Run(20000, 42, 4);
+    MonteCarloResults second = monteCarlo.Run(20000, 42, 4);
+    EXPECT_DOUBLE_EQ(first.meanCost, second.meanCost);
+    EXPECT_DOUBLE_EQ(first.p99, second.p99);
+
+    // Single-threaded run draws the same paths
+    MonteCarloResults serial = monteCarlo.Run(20000, 42, 1);
+    EXPECT_DOUBLE_EQ(first.p50, serial.p50);
+
+    // Mean shortfall matches the closed-form expected cost; spread matches its variance
+    AlmgrenChrissModel model(params);
+    double standardError = std::sqrt(model.Variance() / 20000);
+    EXPECT_NEAR(first.meanCost, model.ExpectedCost() + 1.0, 4 * standardError);
+    EXPECT_NEAR(first.stdDevCost, std::sqrt(model.Variance()), 0.05 * std::sqrt(model.Variance()));
+    EXPECT_LE(first.p95, first.p99);
+    EXPECT_GE(first.expectedShortfall95, first.p95);
+}
+
+TEST(TradeSimulatorTest, GridMatchesSingleSimulations) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    for (int i = 0; i < 20; ++i) {
+        book.asks.push_back({ 101.0 + i, 5.0 });
+    }
+
+    books.Append(book);
+
+    std::vector<double> quantities;
+    for (int i = 70; i > 0; --i) {
+        quantities.push_back(1.5 * i);
+    }
+    std::vector<double> volatilities = { 0.0, 0.02, 0.05 };
+    std::vector<double> feeTiers = { 0.0005, 0.001 };
+
+    GridResults grid = simulator.SimulateGrid(Side::Buy, quantities, volatilities, feeTiers);
+    ASSERT_EQ(grid.books, 1u);
+    ASSERT_EQ(grid.cells.size(), quantities.size() * volatilities.size() * feeTiers.size());
+
+    for (size_t v = 0; v < volatilities.size(); ++v) {
+        for (size_t f = 0; f < feeTiers.size(); ++f) {
+            for (size_t q = 0; q < quantities.size(); q += 7) {
+                SimulationResults single = simulator.SimulateTrade(Side::Buy, quantities[q], volatilities[v], feeTiers[f]);
+                EXPECT_NEAR(grid.At(0, q, v, f).netCost, single.netCost, 1e-9);
+                EXPECT_DOUBLE_EQ(grid.At(0, q, v, f).unfilledQuantity, single.unfilledQuantity);
+            }
+        }
+    }
+
+    // The largest size, 105, runs 5 past the 100 lots of asks
+    EXPECT_DOUBLE_EQ(grid.At(0, 0, 0, 0).unfilledQuantity, 5.0);
+    EXPECT_DOUBLE_EQ(grid.At(0, 7, 0, 0).unfilledQuantity, 0.0);
+}
+
+TEST(TradeSimulatorTest, ScheduleReplaysRecordedBooks) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    auto start = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+
+    // Ten books one second apart, the ask stepping up by one each second; every step clears the old touch
+    {
+        for (int i = 0; i < 10; ++i) {
+            OrderBook book;
+            book.timestamp = start + std::chrono::seconds(i);
+            book.sequence = 1000 + i;
+            book.bids.push_back({ 99.0 + i, 100.0 });
+            book.asks.push_back({ 101.0 + i, 100.0 });
+            books.Append(book);
+        }
+    }
+
+    ExecutionSchedule schedule;
+    schedule.start = start;
+    schedule.duration = 10.0;
+    schedule.slices = 10;
+    schedule.quantity = 50.0;
+    schedule.feeTier = 0.0;
+
+    // One equal child per book: average price 101 + 4.5 against an arrival mid of 100
+    ScheduleResults twap = simulator.SimulateSchedule(schedule);
+    ASSERT_EQ(twap.fills.size(), 10u);
+    EXPECT_DOUBLE_EQ(twap.filledQuantity, 50.0);
+    EXPECT_DOUBLE_EQ(twap.arrivalPrice, 100.0);
+    EXPECT_NEAR(twap.averagePrice, 105.5, 1e-9);
+    EXPECT_NEAR(twap.slippage, 5.5, 1e-9);
+
+    // 10% of the 100 lots cleared by each step, so the parent completes after five books
+    schedule.type = ScheduleType::POV;
+    schedule.participationRate = 0.1;
+    ScheduleResults pov = simulator.SimulateSchedule(schedule);
+    ASSERT_EQ(pov.fills.size(), 5u);
+    EXPECT_DOUBLE_EQ(pov.filledQuantity, 50.0);
+    EXPECT_EQ(pov.fills.front().sequence, 1001u);
+}
+
+TEST(SimdKernelsTest, MatchScalarReference) {
+    std::vector<double> quantities;
+    std::vector<double> volatilities;
+    std::vector<std::pair<double, double>> levels;
+    for (int i = 0; i < 37; ++i) {
+        quantities.push_back(1.0 + 13.0 * i);
+        volatilities.push_back(0.01 * (i % 5));
+        levels.push_back({ 100.0 + 0.5 * i, 1.0 + i });
+    }
+
+    double notional = 0.0;
+    for (const auto& level : levels) {
+        notional += level.first * level.second;
+    }
+    EXPECT_NEAR(SimdKernels::LevelNotional(levels.data(), levels.size()), notional, 1e-9 * notional);
+
+    double depth = 0.0;
+    double dot = 0.0;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        depth += levels[i].second;
+        dot += quantities[i] * volatilities[i];
+    }
+    EXPECT_NEAR(SimdKernels::LevelDepth(levels.data(), levels.size()), depth, 1e-9 * depth);
+    EXPECT_NEAR(SimdKernels::Dot(quantities.data(), volatilities.data(), quantities.size()), dot, 1e-9 * dot);
+
+    std::vector<double> impacts(quantities.size());
+    SimdKernels::MarketImpact(quantities.data(), volatilities.data(), quantities.size(), 0.01, 0.0001, 1.0, impacts.data());
+
+    std::vector<double> logits(quantities.size());
+    std::vector<double> probabilities(quantities.size());
+    for (size_t i = 0; i < quantities.size(); ++i) {
+        logits[i] = 0.05 * quantities[i] - 12.0;
+    }
+    SimdKernels::Sigmoid(logits.data(), logits.size(), probabilities.data());
+
+    for (size_t i = 0; i < quantities.size(); ++i) {
+        double q = quantities[i];
+        EXPECT_NEAR(impacts[i], 0.01 * q + 0.0001 * q * q + volatilities[i] * std::sqrt(q), 1e-12 * (1 + impacts[i]));
+        EXPECT_NEAR(probabilities[i], 1 / (1 + std::exp(-logits[i])), 1e-13);
+    }
+}
+
+TEST(LatencyHistogramTest, PercentilesWithinBucketPrecision) {
+    LatencyHistogram histogram;
+    for (uint64_t i = 1; i <= 100000; ++i) {
+        histogram.Record(i * 10);
+    }
+
+    EXPECT_EQ(histogram.Count(), 100000u);
+    EXPECT_EQ(histogram.Max(), 1000000u);
+    EXPECT_NEAR(static_cast<double>(histogram.Percentile(50)), 500000.0, 500000.0 * 0.016);
+    EXPECT_NEAR(static_cast<double>(histogram.Percentile(99)), 990000.0, 990000.0 * 0.016);
+    EXPECT_EQ(histogram.Percentile(100), 1000000u);
+}
+
+TEST(ConsolidatedBookTest, IncrementalMergeAndRouting) {
+    OrderBook a;
+    a.venue = "A";
+    a.asks = { { 101.0, 5.0 }, { 103.0, 5.0 } };
+    a.bids = { { 100.0, 5.0 } };
+    OrderBook b;
+    b.venue = "B";
+    b.asks = { { 100.8, 5.0 }, { 102.0, 5.0 } };
+    b.bids = { { 99.5, 5.0 } };
+
+    ConsolidatedBook consolidated;
+    consolidated.Update(a);
+    consolidated.Update(b);
+    consolidated.SetVenueFee("A", 0.0);
+    consolidated.SetVenueFee("B", 0.5);
+
+    // B's touch costs 100.8 + 0.5 = 101.3 per unit with its fee, so A's 101 level fills first
+    RoutingPlan touch = consolidated.Route<Side::Buy>(5.0);
+    ASSERT_EQ(touch.allocations.size(), 1u);
+    EXPECT_EQ(touch.allocations[0].venue, "A");
+    EXPECT_DOUBLE_EQ(touch.fees, 0.0);
+
+    RoutingPlan plan = consolidated.Route<Side::Buy>(10.0);
+    ASSERT_EQ(plan.allocations.size(), 2u);
+    EXPECT_DOUBLE_EQ(plan.allocations[0].quantity, 5.0);
+    EXPECT_DOUBLE_EQ(plan.allocations[1].quantity, 5.0);
+    EXPECT_DOUBLE_EQ(plan.fees, 5.0 * 0.5);
+    EXPECT_DOUBLE_EQ(plan.averagePrice, 100.9);
+
+    // A fractional 0.001 tier leaves B's touch at 100.801, ahead of A
+    consolidated.SetVenueFee("B", 0.001);
+    RoutingPlan cheapFee = consolidated.Route<Side::Buy>(5.0);
+    ASSERT_EQ(cheapFee.allocations.size(), 1u);
+    EXPECT_EQ(cheapFee.allocations[0].venue, "B");
+    EXPECT_DOUBLE_EQ(cheapFee.fees, 5.0 * 0.001);
+
+    // Incremental update of A's second level matches a merge from scratch
+    a.asks = { { 101.0, 5.0 }, { 101.5, 2.0 }, { 102.0, 1.0 } };
+    EXPECT_TRUE(consolidated.Update(a));
+    EXPECT_FALSE(consolidated.Update(a));
+
+    ConsolidatedBook fresh;
+    fresh.Update(b);
+    fresh.Update(a);
+    const auto& asks = consolidated.Levels<Side::Buy>();
+    std::vector<double> prices;
+    for (const auto& level : asks) prices.push_back(level.price);
+    EXPECT_EQ(prices, (std::vector<double>{ 100.8, 101.0, 101.5, 102.0, 102.0 }));
+    EXPECT_EQ(consolidated.Snapshot().asks, fresh.Snapshot().asks);
+    EXPECT_EQ(consolidated.Snapshot().asks[3], (std::pair<double, double>(102.0, 6.0)));
+}
+
+TEST(ConsolidatedBookTest, SingleVenueRouteMatchesSimulateTrade) {
+    BookStore books;
+    TradeSimulator simulator(books, "X");
+    OrderBook book;
+    book.venue = "X";
+    book.asks = { { 101.0, 5.0 }, { 102.0, 5.0 }, { 103.0, 5.0 } };
+    book.bids = { { 100.0, 5.0 }, { 99.0, 5.0 }, { 98.0, 5.0 } };
+    books.Append(book);
+    simulator.OnBook(book);
+    simulator.SetVenueFee("X", 0.001);
+
+    // Same fee unit, reference and impact, so one venue routes to exactly the single-venue cost
+    for (Side side : { Side::Buy, Side::Sell }) {
+        SimulationResults routed = simulator.SimulateRoutedTrade(side, 12.0, 0.02);
+        SimulationResults direct = simulator.SimulateTrade(side, 12.0, 0.02, 0.001);
+        EXPECT_DOUBLE_EQ(routed.fees, direct.fees);
+        EXPECT_DOUBLE_EQ(routed.slippage, direct.slippage);
+        EXPECT_DOUBLE_EQ(routed.netCost, direct.netCost);
+    }
+}
+
+TEST(ConsolidatedBookTest, RoutedTradesSplitAcrossVenuesAndFlagUnfilledSize) {
+    BookStore books;
+    TradeSimulator simulator(books, "A");
+    OrderBook a;
+    a.venue = "A";
+    a.asks = { { 101.0, 5.0 }, { 103.0, 5.0 } };
+    a.bids = { { 100.0, 5.0 }, { 98.0, 5.0 } };
+    a.askTailSize = 2.0;
+    OrderBook b;
+    b.venue = "B";
+    b.asks = { { 102.0, 5.0 } };
+    b.bids = { { 99.0, 5.0 } };
+    simulator.OnBook(a);
+    simulator.OnBook(b);
+    simulator.SetVenueFee("A", 0.0);
+    simulator.SetVenueFee("B", 0.0);
+    double mid = (101.0 + 100.0) / 2;
+
+    // Buy: A 101, B 102, A 103
+    RoutingPlan buyPlan;
+    SimulationResults buy = simulator.SimulateRoutedTrade(Side::Buy, 12.0, 0.02, &buyPlan);
+    ASSERT_EQ(buyPlan.allocations.size(), 2u);
+    EXPECT_DOUBLE_EQ(buyPlan.allocations[0].quantity, 7.0);
+    EXPECT_DOUBLE_EQ(buyPlan.allocations[1].quantity, 5.0);
+    EXPECT_DOUBLE_EQ(buy.slippage, (5 * 101.0 + 5 * 102.0 + 2 * 103.0) / 12 - mid);
+    EXPECT_DOUBLE_EQ(buy.unfilledQuantity, 0.0);
+
+    // Impact is charged once on the parent size, not per child order
+    books.Append(a);
+    EXPECT_DOUBLE_EQ(buy.marketImpact, simulator.SimulateTrade(Side::Buy, 12.0, 0.02, 0.0).marketImpact);
+
+    // Sell: A 100, B 99, A 98
+    RoutingPlan sellPlan;
+    SimulationResults sell = simulator.SimulateRoutedTrade(Side::Sell, 12.0, 0.02, &sellPlan);
+    ASSERT_EQ(sellPlan.allocations.size(), 2u);
+    EXPECT_DOUBLE_EQ(sellPlan.allocations[0].quantity, 7.0);
+    EXPECT_DOUBLE_EQ(sellPlan.allocations[1].quantity, 5.0);
+    EXPECT_DOUBLE_EQ(sell.slippage, mid - (5 * 100.0 + 5 * 99.0 + 2 * 98.0) / 12);
+
+    // 20 lots take the 15 visible asks and A's 2-lot tail; the last 3 are priced at B's cheaper tail but unfilled
+    RoutingPlan deepPlan;
+    SimulationResults deep = simulator.SimulateRoutedTrade(Side::Buy, 20.0, 0.02, &deepPlan);
+    double tailA = 103.0 * (1.0 + CONFIG_TAIL_PRICE_PENALTY);
+    double tailB = 102.0 * (1.0 + CONFIG_TAIL_PRICE_PENALTY);
+    EXPECT_DOUBLE_EQ(deep.unfilledQuantity, 3.0);
+    EXPECT_DOUBLE_EQ(deepPlan.filledQuantity, 17.0);
+    EXPECT_DOUBLE_EQ(deepPlan.allocations[0].quantity, 12.0);
+    EXPECT_DOUBLE_EQ(deepPlan.allocations[1].quantity, 8.0);
+    EXPECT_DOUBLE_EQ(deep.slippage, (5 * 101.0 + 5 * 102.0 + 5 * 103.0 + 2 * tailA + 3 * tailB) / 20 - mid);
+
+    // Sell side has no tail on either venue, so everything past the 15 visible bids is unfilled
+    SimulationResults deepSell = simulator.SimulateRoutedTrade(Side::Sell, 20.0, 0.02);
+    EXPECT_DOUBLE_EQ(deepSell.unfilledQuantity, 5.0);
+}
+
+TEST(ConsolidatedBookTest, OtherVenuesOnlyReachTheConsolidatedBook) {
+    BookStore books;
+    TradeSimulator simulator(books, "A");
+    OrderBook a;
+    a.venue = "A";
+    a.asks = { { 101.0, 5.0 }, { 102.0, 5.0 } };
+    a.bids = { { 100.0, 5.0 } };
+    OrderBook b;
+    b.venue = "B";
+    b.asks = { { 111.0, 5.0 }, { 112.0, 5.0 } };
+    b.bids = { { 110.0, 5.0 } };
+
+    auto publish = [&books, &simulator](OrderBook next, const OrderBook* previous) {
+        StampBook(next, books.history.empty() ? nullptr : &books.history.back(), previous);
+        books.Append(next);
+        simulator.OnBook(books.history.back());
+    };
+    publish(a, nullptr);
+    publish(b, nullptr);
+    OrderBook lastA = books.history[0];
+
+    // B's book is newer but A's simulations still price on A
+    BookStore onlyA;
+    onlyA.Append(a);
+    SimulationResults expected = TradeSimulator(onlyA, "A").SimulateTrade(Side::Buy, 5.0, 0.02, 0.0);
+    EXPECT_DOUBLE_EQ(simulator.SimulateTrade(Side::Buy, 5.0, 0.02, 0.0).slippage, expected.slippage);
+    EXPECT_EQ(simulator.GetConsolidatedBook().Snapshot().asks.size(), 4u);
+    StandingSimulation request;
+    request.quantity = 5.0;
+    ASSERT_TRUE(simulator.Refresh(request));
+    EXPECT_DOUBLE_EQ(request.referencePrice, 100.5);
+
+    // A repeated A book diffs against A's previous book, not B's, so nothing changed
+    publish(a, &lastA);
+    EXPECT_EQ(books.history.back().askDirtyFrom, OrderBook::Unchanged);
+    EXPECT_EQ(books.history.back().bidDirtyFrom, OrderBook::Unchanged);
+    publish(b, &books.history[1]);
+    EXPECT_FALSE(simulator.Refresh(request));
+
+    // Alternating venues are not price moves for A's volatility estimate
+    TradeSimulator interleaved(books, "A");
+    TradeSimulator alone(books, "A");
+    auto start = std::chrono::system_clock::now();
+    for (int i = 0; i < 2 * CONFIG_VOLATILITY_MIN_SAMPLES; ++i) {
+        a.timestamp = b.timestamp = start + std::chrono::seconds(i);
+        a.asks[0].first = 101.0 + (i % 3) * 0.01;
+        interleaved.OnBook(a);
+        interleaved.OnBook(b);
+        alone.OnBook(a);
+    }
+    EXPECT_EQ(interleaved.CurrentVolatilitySource(), VolatilitySource::Live);
+    EXPECT_DOUBLE_EQ(interleaved.CurrentVolatility(), alone.CurrentVolatility());
+}
+
+TEST(SpscRingTest, TransfersInOrderAcrossThreads) {
+    SpscRing<uint64_t> ring(64);
+    const uint64_t count = 200000;
+
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t value = i;
+            while (!ring.TryPush(std::move(value))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t value = 0;
+    while (expected < count) {
+        ring.Wait();
+        while (ring.TryPop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.Empty());
+}
+
+TEST(BroadcastRingTest, EveryConsumerSeesEverySequence) {
+    BroadcastRing<uint64_t> ring(64, RingFullPolicy::Block);
+    const uint64_t count = 100000;
+    size_t consumers[2] = { ring.AddConsumer(), ring.AddConsumer() };
+    uint64_t received[2] = { 0, 0 };
+    bool ordered[2] = { true, true };
+
+    std::vector<std::thread> readers;
+    for (int c = 0; c < 2; ++c) {
+        readers.emplace_back([&, c] {
+            while (received[c] < count) {
+                ring.Wait(consumers[c]);
+                ring.Consume(consumers[c], [&](const uint64_t& value) {
+                    ordered[c] = ordered[c] && value == received[c];
+                    ++received[c];
+                });
+            }
+        });
+    }
+
+    for (uint64_t i = 0; i < count; ++i) {
+        ring.Publish(uint64_t(i));
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    for (int c = 0; c < 2; ++c) {
+        EXPECT_EQ(received[c], count);
+        EXPECT_TRUE(ordered[c]);
+    }
+}
+
+TEST(BroadcastRingTest, DropPolicyNeverWaitsForASlowConsumer) {
+    BroadcastRing<uint64_t> ring(4);
+    size_t fast = ring.AddConsumer();
+    size_t slow = ring.AddConsumer();
+
+    // The slow consumer never reads, so the fifth element finds its slot still held and is dropped
+    for (uint64_t i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.Publish(uint64_t(i)));
+    }
+    EXPECT_FALSE(ring.Publish(uint64_t(4)));
+    EXPECT_FALSE(ring.Publish(uint64_t(5)));
+    EXPECT_EQ(ring.Dropped(), 2u);
+    EXPECT_EQ(ring.Published(), 4u);
+    EXPECT_EQ(ring.Consume(fast, [](const uint64_t&) {}), 4u);
+
+    // Once the slow consumer catches up, publishing resumes with the next sequence
+    uint64_t last = 0;
+    EXPECT_EQ(ring.Consume(slow, [&](const uint64_t& value) { last = value; }), 4u);
+    EXPECT_EQ(last, 3u);
+    EXPECT_TRUE(ring.Publish(uint64_t(6)));
+    EXPECT_EQ(ring.Dropped(), 2u);
+}
+
+TEST(WebSocketHandlerTest, ReconnectsWithBackoffAndResubscribes) {
+    // Loopback feed: each connection reads the six subscriptions, sends one book, and the first then closes
+    boost::asio::io_context serverIoc;
+    tcp::acceptor acceptor(serverIoc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    FeedEndpoint endpoint;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = std::to_string(acceptor.local_endpoint().port());
+    endpoint.path = "/";
+
+    const std::vector<std::string> expected = { "sub-0", "sub-1", "sub-2", "sub-3", "sub-4", "sub-5" };
+    std::vector<std::string> received[2];
+    std::chrono::steady_clock::time_point dropped;
+    std::chrono::steady_clock::time_point reconnected;
+    std::promise<void> firstHandshake;
+
+    boost::asio::co_spawn(serverIoc, [&]() -> boost::asio::awaitable<void> {
+        for (int c = 0; c < 2; ++c) {
+            websocket::stream<tcp::socket> ws(co_await acceptor.async_accept(boost::asio::use_awaitable));
+            reconnected = std::chrono::steady_clock::now();
+            co_await ws.async_accept(boost::asio::use_awaitable);
+            if (c == 0) {
+                firstHandshake.set_value();
+            }
+            while (received[c].size() < expected.size()) {
+                beast::flat_buffer buffer;
+                co_await ws.async_read(buffer, boost::asio::use_awaitable);
+                received[c].push_back(beast::buffers_to_string(buffer.data()));
+            }
+
+            std::string book = R"({"symbol":"TEST","asks":[[101.0,5.0]],"bids":[[100.0,5.0]]})";
+            co_await ws.async_write(boost::asio::buffer(book), boost::asio::use_awaitable);
+            beast::error_code ec;
+            if (c == 0) {
+                dropped = std::chrono::steady_clock::now();
+                co_await ws.async_close(websocket::close_code::going_away, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            }
+            else {
+                // Answer the client's closing handshake
+                beast::flat_buffer buffer;
+                co_await ws.async_read(buffer, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            }
+        }
+        }, boost::asio::detached);
+    std::thread server([&] { serverIoc.run_for(std::chrono::seconds(15)); });
+
+    boost::asio::io_context ioc;
+    BroadcastRing<OrderBook> ring(16);
+    size_t consumer = ring.AddConsumer();
+    LatencyMonitor latency;
+    std::atomic<bool> stopping{ false };
+    WebSocketHandler handler(ioc, endpoint, ring, latency, stopping);
+    handler.AddSubscription("sub-0");
+    handler.Start();
+    std::thread io([&] { ioc.run(); });
+
+    // Subscriptions added while connected queue behind the resubscription instead of overlapping it
+    firstHandshake.get_future().wait_for(std::chrono::seconds(5));
+    for (int i = 1; i < 6; ++i) {
+        handler.AddSubscription("sub-" + std::to_string(i));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (ring.Published() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    stopping = true;
+    handler.Stop();
+    io.join();
+    server.join();
+
+    EXPECT_EQ(ring.Published(), 2u);
+    EXPECT_EQ(ring.Consume(consumer, [](const OrderBook& book) { EXPECT_EQ(book.symbol, "TEST"); }), 2u);
+    EXPECT_EQ(received[0], expected);
+    EXPECT_EQ(received[1], expected);
+    EXPECT_GE(reconnected - dropped, std::chrono::milliseconds(CONFIG_RETRY_INITIAL_BACKOFF_MS));
+}
+
+TEST(WebSocketHandlerTest, DepthOverridesApplyOnTheStrand) {
+    boost::asio::io_context ioc;
+    FeedEndpoint endpoint;
+    BroadcastRing<OrderBook> ring(8);
+    LatencyMonitor latency;
+    std::atomic<bool> stopping{ false };
+    WebSocketHandler handler(ioc, endpoint, ring, latency, stopping);
+
+    // The override is queued on the strand and applies once the strand has run it
+    std::thread writer([&handler] { handler.SetMaxDepth("TEST", 1); });
+    writer.join();
+    EXPECT_EQ(handler.GetMaxDepth("TEST"), static_cast<size_t>(CONFIG_MAX_DEPTH));
+    ioc.run();
+    EXPECT_EQ(handler.GetMaxDepth("TEST"), 1u);
+
+    beast::flat_buffer buffer;
+    std::string book = R"({"symbol":"TEST","asks":[[101.0,5.0],[102.0,3.0]],"bids":[[100.0,5.0]]})";
+    buffer.commit(boost::asio::buffer_copy(buffer.prepare(book.size()), boost::asio::buffer(book)));
+    handler.ProcessData(buffer);
+    ASSERT_NE(ring.Latest(), nullptr);
+    EXPECT_EQ(ring.Latest()->asks.size(), 1u);
+    EXPECT_DOUBLE_EQ(ring.Latest()->askTailSize, 3.0);
+}
+
+TEST(TradingEngineTest, InstancesAreIndependent) {
+    TradingEngine first;
+    TradingEngine second;
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&first) % 64, 0u);
+
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    book.asks.push_back({ 101.0, 5.0 });
+    first.Books().Append(book);
+    EXPECT_EQ(first.Books().history.size(), 1u);
+    EXPECT_TRUE(second.Books().history.empty());
+
+    // A book published on one engine reaches only that engine's consumers
+    size_t firstConsumer = first.BookRing().AddConsumer();
+    size_t secondConsumer = second.BookRing().AddConsumer();
+    first.BookRing().Publish(OrderBook(book));
+    EXPECT_FALSE(first.BookRing().Empty(firstConsumer));
+    EXPECT_TRUE(second.BookRing().Empty(secondConsumer));
+}
+
+#ifdef __linux__
+TEST(ThreadPlacementTest, NamesAndPinsThread) {
+    char name[16] = {};
+    bool pinned = false;
+    std::thread worker([&] {
+        ConfigureCurrentThread("ts-test", 0);
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        cpu_set_t cpus;
+        pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        pinned = CPU_COUNT(&cpus) == 1 && CPU_ISSET(0, &cpus);
+    });
+    worker.join();
+
+    EXPECT_STREQ(name, "ts-test");
+    EXPECT_TRUE(pinned);
+}
+#endif
+
+TEST(WorkStealingPoolTest, NestedJobsAndArenas) {
+    WorkStealingPool pool(3);
+
+    // Nested parallel loops complete because callers only wait for helpers already inside their loop
+    std::atomic<size_t> total{ 0 };
+    pool.ParallelFor(8, [&](size_t) {
+        pool.ParallelFor(100, [&](size_t i) { total.fetch_add(i); });
+    });
+    EXPECT_EQ(total.load(), 8u * 4950u);
+
+    // Futures carry results and exceptions
+    std::future<int> value = pool.Submit([] { return 42; });
+    std::future<int> failure = pool.Submit([]() -> int { throw std::invalid_argument("job"); });
+    EXPECT_EQ(value.get(), 42);
+    EXPECT_THROW(failure.get(), std::invalid_argument);
+
+    // A scope returns its memory to the arena
+    ScratchArena arena(1024);
+    double* first = nullptr;
+    {
+        ScratchArena::Scope scope(arena);
+        first = arena.Allocate<double>(16);
+    }
+    EXPECT_EQ(arena.Allocate<double>(16), first);
+    EXPECT_EQ(arena.Capacity(), 1024u);
+}
+
+TEST(WorkStealingPoolTest, ParallelForCallerRunsOnlyItsOwnIndices) {
+    WorkStealingPool pool(1);
+
+    // Occupy the only worker, then queue an unrelated job behind it
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::future<void> blocker = pool.Submit([released] { released.wait(); });
+    std::future<std::thread::id> unrelated = pool.Submit([] { return std::this_thread::get_id(); });
+
+    // The caller handles every index itself and returns without picking up the queued job
+    std::vector<std::thread::id> ranOn(4);
+    pool.ParallelFor(4, [&](size_t i) { ranOn[i] = std::this_thread::get_id(); });
+    for (const std::thread::id& id : ranOn) {
+        EXPECT_EQ(id, std::this_thread::get_id());
+    }
+
+    release.set_value();
+    blocker.get();
+    EXPECT_NE(unrelated.get(), std::this_thread::get_id());
+}
+
+TEST(TradeSimulatorTest, SubmittedJobsMatchDirectCalls) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    for (int i = 0; i < 10; ++i) {
+        book.asks.push_back({ 101.0 + i, 5.0 });
+    }
+    books.Append(book);
+
+    std::vector<std::future<SimulationResults>> jobs;
+    for (int i = 1; i <= 16; ++i) {
+        jobs.push_back(simulator.Submit([i](TradeSimulator& s) { return s.SimulateTrade(Side::Buy, 2.5 * i, 0.02, 0.001); }));
+    }
+    for (int i = 1; i <= 16; ++i) {
+        SimulationResults direct = simulator.SimulateTrade(Side::Buy, 2.5 * i, 0.02, 0.001);
+        EXPECT_DOUBLE_EQ(jobs[i - 1].get().netCost, direct.netCost);
+    }
+}
+
+TEST(TradeSimulatorTest, SubmittedJobsRunAlongsideModelUpdates) {
+    BookStore books;
+    TradeSimulator simulator(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    book.asks.push_back({ 101.0, 10.0 });
+    books.Append(book);
+
+    // Jobs read the live models while this thread keeps feeding books; the model lock keeps them apart
+    std::vector<std::future<SimulationResults>> jobs;
+    for (int i = 0; i < 64; ++i) {
+        jobs.push_back(simulator.Submit([](TradeSimulator& s) { return s.SimulateTrade(Side::Buy, 5.0, 0.001); }));
+        jobs.push_back(simulator.Submit([](TradeSimulator& s) { return s.SimulateRoutedTrade(Side::Buy, 5.0, 0.02); }));
+        book.asks[0].first = 101.0 + 0.01 * (i % 7);
+        book.sequence = i + 2;
+        book.timestamp += std::chrono::milliseconds(100);
+        simulator.OnBook(book);
+        simulator.SetVenueFee(book.venue, 0.001 * (i % 3));
+    }
+    for (auto& job : jobs) {
+        EXPECT_TRUE(std::isfinite(job.get().netCost));
+    }
+
+    // The engine routes on-demand requests through the same path once its simulation thread built the simulator;
+    // the feed endpoint refuses connections, so only the pool and that thread do any work
+    FeedEndpoint closed;
+    closed.host = "127.0.0.1";
+    closed.port = "1";
+    TradingEngine engine(closed);
+    engine.Books().Append(book);
+    engine.Start();
+    SimulationResults pooled = engine.Submit([](TradeSimulator& s) { return s.SimulateTrade(Side::Buy, 5.0, 0.02, 0.001); }).get();
+    TradeSimulator direct(engine.Books());
+    EXPECT_DOUBLE_EQ(pooled.netCost, direct.SimulateTrade(Side::Buy, 5.0, 0.02, 0.001).netCost);
+    EXPECT_THROW(engine.SetVenueFee(book.venue, 2.0), std::invalid_argument);
+
+    // An engine stopped without starting never builds a simulator, and Submit fails instead of waiting forever
+    TradingEngine idle;
+    idle.Stop();
+    EXPECT_THROW(idle.Submit([](TradeSimulator& s) { return s.CurrentVolatility(); }), std::runtime_error);
+}
+
+TEST(OrderBookTest, DepthTruncation) {
+    auto levels = nlohmann::json::parse("[[101.0, 5.0], [102.0, 10.0], [103.0, 2.0], [104.0, 3.0]]");
+
+    std::vector<std::pair<double, double>> side;
+    double tailSize = 0.0;
+    ParseBookSide(levels, 2, side, tailSize);
+
+    ASSERT_EQ(side.size(), 2u);
+    EXPECT_DOUBLE_EQ(side[1].first, 102.0);
+    EXPECT_DOUBLE_EQ(tailSize, 5.0);
+}
+
+TEST(OrderBookTest, FillsPastTruncatedLevelsPayTheTail) {
+    BookStore books;
+    BasicTradeSimulator<BookWalkSlippage<SlippageReference::Touch>, CalibratedImpact, OnlineMakerTaker> simulator(books);
+    OrderBook book;
+    book.bids.push_back({ 100.0, 10.0 });
+    book.asks.push_back({ 101.0, 5.0 });
+    book.asks.push_back({ 102.0, 5.0 });
+    book.askTailSize = 5.0;
+    books.Append(book);
+
+    // 5 of the 10 units come from the tail at 102 * (1 + penalty)
+    double tailPrice = 102.0 * (1.0 + CONFIG_TAIL_PRICE_PENALTY);
+    SimulationResults inTail = simulator.SimulateTrade(Side::Buy, 15.0, 0.02, 0.001);
+    EXPECT_NEAR(inTail.slippage, (5 * 101.0 + 5 * 102.0 + 5 * tailPrice) / 15.0 - 101.0, 1e-9);
+    EXPECT_DOUBLE_EQ(inTail.unfilledQuantity, 0.0);
+
+    SimulationResults beyond = simulator.SimulateTrade(Side::Buy, 20.0, 0.02, 0.001);
+    EXPECT_NEAR(beyond.slippage, (5 * 101.0 + 5 * 102.0 + 10 * tailPrice) / 20.0 - 101.0, 1e-9);
+    EXPECT_DOUBLE_EQ(beyond.unfilledQuantity, 5.0);
+
+    std::vector<SimulationResults> curve = simulator.SimulateTradeCurve(Side::Buy, { 15.0, 20.0 }, { 0.02 }, { 0.001 });
+    ASSERT_EQ(curve.size(), 2u);
+    EXPECT_NEAR(curve[0].slippage, inTail.slippage, 1e-9);
+    EXPECT_NEAR(curve[1].slippage, beyond.slippage, 1e-9);
+    EXPECT_DOUBLE_EQ(curve[1].unfilledQuantity, 5.0);
+}
+
+TEST(LoggerTest, BackgroundWriterKeepsEveryThreadsRecords) {
+    const std::string marker = "logger-test-" + std::to_string(LatencyMonitor::NowNs());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t, &marker]() {
+            for (int i = 0; i < 100; ++i) {
+                Logger::Log(marker + " " + std::to_string(t) + ":" + std::to_string(i), "DEBUG");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Logger::Flush();
+
+    std::ifstream logFile(LOG_FILE);
+    std::string line;
+    int found = 0;
+    while (std::getline(logFile, line)) {
+        if (line.rfind("[DEBUG] [", 0) == 0 && line.find(marker) != std::string::npos) {
+            ++found;
+        }
+    }
+    EXPECT_EQ(found, 400);
+}
+
+TEST(LoggerTest, BinaryEventsRoundTripThroughTheDecoder) {
+    if (!CONFIG_BINARY_LOG) {
+        GTEST_SKIP() << "Binary event log disabled";
+    }
+
+    Logger::Flush();
+    uint64_t begin = ReadTimestampCounter();
+    Logger::Event(LogEvent::BookReceived, size_t{ 512 });
+    Logger::Event(LogEvent::BookParsed, size_t{ 10 }, size_t{ 12 }, uint64_t{ 800 });
+    Logger::Event(LogEvent::BookPublished, uint64_t{ 7 });
+    Logger::Flush();
+
+    // Earlier runs append their own sessions; this process wrote the last one
+    std::ifstream file(CONFIG_BINARY_LOG_FILE, std::ios::binary);
+    ASSERT_TRUE(file);
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<binary_log::Session> sessions;
+    ASSERT_TRUE(binary_log::ReadLog(bytes, sessions));
+    ASSERT_FALSE(sessions.empty());
+    const binary_log::Session& session = sessions.back();
+    EXPECT_EQ(session.formats.size(), std::size(kLogEventFormats));
+
+    // The flush closes the batch with a clock sync record taken after the events
+    ASSERT_GE(session.events.size(), 3u);
+    ASSERT_GE(session.syncs.size(), 2u);
+    const binary_log::Event* events = &session.events[session.events.size() - 3];
+    EXPECT_GE(session.syncs.back().counter, events[2].counter);
+
+    const uint16_t ids[] = { static_cast<uint16_t>(LogEvent::BookReceived), static_cast<uint16_t>(LogEvent::BookParsed),
+        static_cast<uint16_t>(LogEvent::BookPublished) };
+    const std::vector<uint64_t> arguments[] = { { 512 }, { 10, 12, 800 }, { 7 } };
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(events[i].id, ids[i]);
+        EXPECT_EQ(events[i].arguments, arguments[i]);
+        EXPECT_GE(events[i].counter, begin);
+    }
+
+    // Rendered with the format strings from the session header
+    EXPECT_EQ(binary_log::FormatEvent(session.formats.at(ids[1]), events[1].arguments),
+        "book parsed: 10 ask levels, 12 bid levels in 800 ns");
+    EXPECT_EQ(binary_log::FormatEvent("%.2f %d|%x", { 0x4004000000000000ull, static_cast<uint64_t>(-3), 255 }), "2.50 -3|ff");
+    EXPECT_EQ(binary_log::FormatEvent("%u %u", { 1 }), "1 <missing>");
+
+    // Timestamps interpolate between the sync records around them
+    std::vector<binary_log::ClockSync> syncs = { { 1000, 5000 }, { 3000, 9000 } };
+    EXPECT_EQ(binary_log::ToUnixNs(syncs, 2000), 7000);
+    EXPECT_EQ(binary_log::ToUnixNs(syncs, 4000), 11000);
+}
+
+TEST(LoggerTest, DecoderOrdersEventsAcrossBatches) {
+    std::string bytes;
+    auto append = [&bytes](auto value) { bytes.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    auto record = [&](uint16_t id, uint64_t counter, uint64_t argument) {
+        append(id);
+        append(uint8_t{ 1 });
+        append(uint8_t{ 0 });
+        append(counter);
+        append(argument);
+    };
+
+    // Session header with one format, then two batches; the second carries an event older than the first batch
+    append(binary_log::kSessionMarker);
+    bytes.append(binary_log::kBinaryLogMagic, binary_log::kBinaryLogMagicLength);
+    append(binary_log::kBinaryLogVersion);
+    append(uint16_t{ 1 });
+    append(uint64_t{ 100 });
+    append(int64_t{ 1000 });
+    std::string format = "event %u";
+    append(uint16_t{ 1 });
+    append(static_cast<uint16_t>(format.size()));
+    bytes += format;
+    record(1, 300, 3);
+    record(1, 400, 4);
+    record(binary_log::kClockSyncId, 450, 1350);
+    record(1, 200, 2);
+    record(1, 400, 5);
+    record(1, 500, 6);
+    record(binary_log::kClockSyncId, 550, 1450);
+
+    std::vector<binary_log::Session> sessions;
+    ASSERT_TRUE(binary_log::ReadLog(bytes, sessions));
+    ASSERT_EQ(sessions.size(), 1u);
+    std::vector<uint64_t> order;
+    for (const binary_log::Event& event : sessions[0].events) {
+        order.push_back(event.arguments[0]);
+    }
+    EXPECT_EQ(order, (std::vector<uint64_t>{ 2, 3, 4, 5, 6 }));
+    EXPECT_EQ(sessions[0].syncs.size(), 3u);
+    EXPECT_EQ(binary_log::ToUnixNs(sessions[0].syncs, 200), 1100);
+}
+
 // Main Function with Proper Shutdown
 int main() {
     try {
@@ -429,37 +5348,29 @@ int main() {
         testing::InitGoogleTest();
         RUN_ALL_TESTS();
 
-        boost::asio::io_context ioc;
-        WebSocketHandler wsHandler(ioc);
+        TradingEngine engine;
 
         // Register signal handler for proper shutdown
         std::signal(SIGINT, [](int) {
             shouldStop = true;
             });
 
-        // Start WebSocket connection in a separate thread
-        std::thread wsThread([&ioc, &wsHandler]() {
-            wsHandler.Connect();
-            ioc.run();
-            });
-
-        // Start simulation worker thread
-        std::thread simulationThread(SimulationWorker);
+        // Start the WebSocket and simulation threads
+        engine.Start();
+        ConfigureCurrentThread("ts-ui", CONFIG_UI_THREAD_CPU);
 
         // UI thread
         TradeSimulatorUI ui;
         while (!shouldStop) {
-            ui.Render();
+            {
+                StageTimer renderTimer(engine.Latency().Histogram(LatencyStage::Render));
+                ui.Render(engine);
+            }
             std::this_thread::sleep_for(std::chrono::milliseconds(200));
         }
 
         // Cleanup
-        shouldStop = true;
-        cv.notify_all();
-
-        wsHandler.Close();
-        wsThread.join();
-        simulationThread.join();
+        engine.Stop();
 
     }
     catch (const std::exception& e) {
@@ -17,11 +17,80 @@
 
 // Performance Configuration
 #define CONFIG_MAX_HISTORY 1000
-#define CONFIG_RETRY_INTERVAL 5
+#define CONFIG_RETRY_INTERVAL 5 // Longest reconnect backoff and connect/close timeout, in seconds
+#define CONFIG_RETRY_INITIAL_BACKOFF_MS 250 // First reconnect backoff, doubled after each failure
 #define CONFIG_PING_INTERVAL 20
 #define CONFIG_MAX_LATENCY 100
+#define CONFIG_BOOK_QUEUE_CAPACITY 1024 // Books buffered between ingest and the slowest consumer
+#define CONFIG_QUEUE_SPIN_ITERATIONS 2000 // Pause iterations an idle consumer spins before sleeping
+#define CONFIG_BOOK_RING_BLOCK_ON_FULL 0 // 1 makes ingest wait for the slowest book consumer; 0 drops the new book
+
+// Model Configuration
+#define CONFIG_IMPACT_ETA 0.01 // Temporary market impact coefficient
+#define CONFIG_IMPACT_GAMMA 0.0001 // Permanent market impact coefficient
+#define CONFIG_IMPACT_TIME_HORIZON 1.0 // Execution time in seconds
+#define CONFIG_MAKER_TAKER_QTY_COEFF 0.005
+#define CONFIG_MAKER_TAKER_VOL_COEFF -0.1
+#define CONFIG_MAKER_TAKER_INTERCEPT 2.0
+#define CONFIG_RISK_AVERSION 1e-6 // Almgren-Chriss lambda
+#define CONFIG_EXECUTION_SLICES 10 // Almgren-Chriss schedule slices
+
+// Calibration Configuration
+#define CONFIG_CALIBRATION_FORGETTING 0.999 // RLS forgetting factor per observation
+#define CONFIG_CALIBRATION_MIN_SAMPLES 50 // Observations before calibrated impact coefficients are used
+#define CONFIG_CALIBRATION_MIN_ETA 1e-9 // Floor on the calibrated temporary impact handed to the Almgren-Chriss solver
+
+// Volatility Estimation Configuration
+#define CONFIG_VOLATILITY_EWMA_ALPHA 0.01 // Weight of the newest return in the EWMA
+#define CONFIG_VOLATILITY_SLOW_SCALE 10 // Books per return at the slow sampling scale
+#define CONFIG_VOLATILITY_MIN_SAMPLES 100 // Slow-scale returns before the estimate replaces the default
+
+// Maker/Taker Model Configuration
+#define CONFIG_MAKER_TAKER_LEARNING_RATE 0.01 // SGD step size
+#define CONFIG_MAKER_TAKER_L2 0.0001 // L2 regularisation strength
+#define CONFIG_MAKER_TAKER_DEPTH_LEVELS 5 // Levels per side in the depth and imbalance features
+#define CONFIG_MAKER_TAKER_HORIZON_BOOKS 10 // Books a passive probe may rest before it is labelled taker
+#define CONFIG_MAKER_TAKER_MIN_SAMPLES 500 // Training samples before the online model replaces the fixed one
+
+// Slippage Regression Configuration
+#define CONFIG_SLIPPAGE_REGRESSION_DECAY 0.999 // Weight kept by past observations per new observation
+#define CONFIG_SLIPPAGE_REGRESSION_MIN_SAMPLES 20 // Observations before the estimate is considered usable
+
+// Monte Carlo Configuration
+#define CONFIG_MONTE_CARLO_PATHS 10000
+#define CONFIG_MONTE_CARLO_SEED 20240501
+
+// Grid Configuration
+#define CONFIG_GRID_TILE_QUANTITIES 64 // Quantities per work tile in grid sweeps
+
+// Execution Schedule Configuration
+#define CONFIG_SCHEDULE_DURATION 60.0 // Default TWAP/VWAP/POV window in seconds of book time
+#define CONFIG_POV_PARTICIPATION 0.1 // Default share of market volume for POV schedules
+
+// Threading Configuration
+#define CONFIG_WORKER_BUSY_POLL 0 // 1 spins the simulation worker on the book ring instead of sleeping (pinned cores only)
+#define CONFIG_IO_THREAD_CPU -1 // Core for the WebSocket thread; -1 leaves it unpinned
+#define CONFIG_SIMULATION_THREAD_CPU -1 // Core for the simulation worker; -1 leaves it unpinned
+#define CONFIG_UI_THREAD_CPU -1 // Core for the UI (main) thread; -1 leaves it unpinned
+
+// Executor Configuration
+#define CONFIG_WORKER_POOL_THREADS 0 // Work-stealing pool workers; 0 uses every core
+#define CONFIG_SCRATCH_ARENA_BYTES (1 << 20) // Block size of the per-worker scratch arenas
+
+// SIMD Configuration
+#define CONFIG_SIMD_MAX_LEVEL 2 // Highest kernel set to dispatch to: 0 = scalar, 1 = AVX2, 2 = AVX-512
+
+// Order Book Configuration
+#define CONFIG_MAX_DEPTH 50 // Levels kept per side at ingest (0 keeps every level)
+#define CONFIG_TAIL_PRICE_PENALTY 0.001 // Fractional premium over the last kept level for size filled past it
 
 // Logging Configuration
 #define LOG_FILE "simulator.log"
+#define CONFIG_LOG_RING_RECORDS 1024 // Records buffered per logging thread before new ones are dropped
+#define CONFIG_LOG_RECORD_BYTES 240 // Longer messages are truncated
+#define CONFIG_LOG_FLUSH_INTERVAL_MS 10 // Background writer batch interval
+#define CONFIG_BINARY_LOG 1 // Record per-message events in the binary log (decode with LOG_DECODER.cpp)
+#define CONFIG_BINARY_LOG_FILE "simulator.blog"
+#define CONFIG_BINARY_LOG_RING_RECORDS 4096 // Events buffered per thread before new ones are dropped
 
 #endif#pragma once